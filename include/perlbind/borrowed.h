@@ -0,0 +1,368 @@
+#pragma once
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace perlbind {
+
+namespace detail {
+
+// returns the entry after he (or the first entry if null) from the bucket array
+// so the hash's each/keys iterator isn't reset. skips restricted hash
+// placeholders. bucket is the next bucket to scan. hashes with magic (e.g.
+// tied) must be iterated with hv_iternext instead
+inline HE* next_hash_entry(PerlInterpreter* my_perl, HV* hv, HE* he, STRLEN& bucket) noexcept
+{
+  he = he ? HeNEXT(he) : nullptr;
+  for (;;)
+  {
+    for (; he; he = HeNEXT(he))
+    {
+      if (HeVAL(he) != &PL_sv_placeholder)
+        return he;
+    }
+
+    if (!HvARRAY(hv) || bucket > HvMAX(hv))
+      return nullptr;
+
+    he = HvARRAY(hv)[bucket++];
+  }
+}
+
+} // namespace detail
+
+// borrowed types are non-owning views of perl values for function binding
+// parameters. they don't change refcounts, have trivial destructors, and are
+// only valid for the duration of the call (or while the viewed value is alive)
+
+struct scalar_ref
+{
+  scalar_ref(PerlInterpreter* interp, SV* sv) noexcept : my_perl(interp), m_sv(sv) {}
+
+  SV* sv()      const { return m_sv; }
+  SV* deref()   const { return SvRV(m_sv); }
+  size_t size() const { return SvPOK(m_sv) ? sv_len(m_sv) : 0; }
+  svtype type() const { return SvTYPE(m_sv); }
+  const char* c_str() const { return SvPV_nolen(m_sv); }
+
+  bool is_null()       const { return type() == SVt_NULL; }
+  bool is_integer()    const { return SvIOK(m_sv); }
+  bool is_float()      const { return SvNOK(m_sv); }
+  bool is_string()     const { return SvPOK(m_sv); }
+  bool is_reference()  const { return SvROK(m_sv); }
+  bool is_scalar_ref() const { return SvROK(m_sv) && SvTYPE(SvRV(m_sv)) < SVt_PVAV; }
+  bool is_array_ref()  const { return SvROK(m_sv) && SvTYPE(SvRV(m_sv)) == SVt_PVAV; }
+  bool is_hash_ref()   const { return SvROK(m_sv) && SvTYPE(SvRV(m_sv)) == SVt_PVHV; }
+
+  // returns an owning scalar that holds a new reference to the SV
+  scalar to_scalar() const { return scalar(my_perl, SvREFCNT_inc(m_sv)); }
+
+  operator SV*() const { return m_sv; }
+  operator const char*() const { return SvPV_nolen(m_sv); }
+  operator std::string() const
+  {
+    STRLEN len = 0;
+    const char* str = SvPV(m_sv, len);
+    return std::string(str, len);
+  }
+#ifdef __cpp_lib_string_view
+  operator std::string_view() const
+  {
+    STRLEN len = 0;
+    const char* str = SvPV(m_sv, len);
+    return std::string_view(str, len);
+  }
+#endif
+  template <typename T, std::enable_if_t<detail::is_signed_integral_or_enum<T>::value, bool> = true>
+  operator T() const { return static_cast<T>(SvIV(m_sv)); }
+  template <typename T, std::enable_if_t<std::is_unsigned<T>::value, bool> = true>
+  operator T() const { return static_cast<T>(SvUV(m_sv)); }
+  template <typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+  operator T() const { return static_cast<T>(SvNV(m_sv)); }
+  template <typename T, std::enable_if_t<std::is_pointer<T>::value, bool> = true>
+  operator T() const
+  {
+    T value = nullptr;
+    detail::typemap::template get_object<T>(my_perl, m_sv, value);
+    return value;
+  }
+
+  // copy initialized so std::string doesn't also consider its constructors
+  template <typename T>
+  T as() const
+  {
+    T value = *this;
+    return value;
+  }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  SV* m_sv = nullptr;
+};
+
+struct array_ref
+{
+  struct iterator
+  {
+    bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+    iterator& operator++() { ++m_index; return *this; }
+    scalar_ref operator*() const { return (*m_array)[m_index]; }
+
+    const array_ref* m_array;
+    size_t m_index;
+  };
+
+  array_ref(PerlInterpreter* interp, AV* av) noexcept : my_perl(interp), m_av(av) {}
+
+  operator AV*() const { return m_av; }
+  operator SV*() const { return reinterpret_cast<SV*>(m_av); }
+
+  SV* sv() const      { return reinterpret_cast<SV*>(m_av); }
+  size_t size() const { return static_cast<size_t>(av_top_index(m_av) + 1); }
+
+  // returns the element at index, undef if it doesn't exist (array isn't extended)
+  scalar_ref operator[](size_t index) const
+  {
+    if (!SvRMAGICAL(m_av) && index < size())
+    {
+      SV* sv = AvARRAY(m_av)[index];
+      return scalar_ref(my_perl, sv ? sv : &PL_sv_undef);
+    }
+
+    SV** sv = av_fetch(m_av, static_cast<SSize_t>(index), 0);
+    return scalar_ref(my_perl, sv ? *sv : &PL_sv_undef);
+  }
+
+  iterator begin() const noexcept { return { this, 0 }; }
+  iterator end() const noexcept { return { this, size() }; }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  AV* m_av = nullptr;
+};
+
+struct hash_ref
+{
+  struct iterator
+  {
+    bool operator!=(const iterator& other) const { return m_he != other.m_he; }
+    iterator& operator++()
+    {
+      m_he = SvRMAGICAL(m_hv) ? hv_iternext(m_hv) : detail::next_hash_entry(my_perl, m_hv, m_he, m_bucket);
+      return *this;
+    }
+    std::pair<const char*, scalar_ref> operator*() const
+    {
+      return { HePV(m_he, PL_na), scalar_ref(my_perl, hv_iterval(m_hv, m_he)) };
+    }
+
+    // length of the current key (keys may contain embedded nulls)
+    std::size_t key_size() const
+    {
+      STRLEN len = 0;
+      HePV(m_he, len);
+      return len;
+    }
+
+    PerlInterpreter* my_perl;
+    HV* m_hv;
+    HE* m_he;
+    STRLEN m_bucket;
+  };
+
+  hash_ref(PerlInterpreter* interp, HV* hv) noexcept : my_perl(interp), m_hv(hv) {}
+
+  operator HV*() const { return m_hv; }
+  operator SV*() const { return reinterpret_cast<SV*>(m_hv); }
+
+  SV* sv() const      { return reinterpret_cast<SV*>(m_hv); }
+  size_t size() const { return HvUSEDKEYS(m_hv); }
+
+  bool exists(const char* key) const
+  {
+    return hv_exists(m_hv, key, static_cast<I32>(strlen(key)));
+  }
+  bool exists(const std::string& key) const
+  {
+    return hv_exists(m_hv, key.c_str(), static_cast<I32>(key.size()));
+  }
+
+  // returns the value of key, undef if it doesn't exist (no entry is created)
+  scalar_ref operator[](const std::string& key) const
+  {
+    SV** sv = hv_fetch(m_hv, key.c_str(), static_cast<I32>(key.size()), 0);
+    return scalar_ref(my_perl, sv ? *sv : &PL_sv_undef);
+  }
+
+  // iterating doesn't reset the hash's each/keys iterator unless the hash has
+  // magic (e.g. tied) where perl's iterator is used
+  iterator begin() const
+  {
+    STRLEN bucket = 0;
+    if (SvRMAGICAL(m_hv))
+    {
+      hv_iterinit(m_hv);
+      return { my_perl, m_hv, hv_iternext(m_hv), bucket };
+    }
+    return { my_perl, m_hv, detail::next_hash_entry(my_perl, m_hv, nullptr, bucket), bucket };
+  }
+  iterator end() const noexcept { return { my_perl, m_hv, nullptr, 0 }; }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  HV* m_hv = nullptr;
+};
+
+// view of the remaining stack items of a call for variadic parameters
+// items are read from the stack base so the view stays valid if a nested call
+// reallocates the stack
+struct args
+{
+  struct iterator
+  {
+    bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+    iterator& operator++() { ++m_index; return *this; }
+    scalar_ref operator*() const { return (*m_args)[m_index]; }
+
+    const args* m_args;
+    size_t m_index;
+  };
+
+  args(PerlInterpreter* interp, int ax, int start, int items) noexcept
+    : my_perl(interp), m_ax(ax), m_start(start), m_items(items) {}
+
+  size_t size() const { return static_cast<size_t>(m_items - m_start); }
+  bool empty() const  { return m_items == m_start; }
+
+  scalar_ref operator[](size_t index) const
+  {
+    return scalar_ref(my_perl, PL_stack_base[m_ax + m_start + static_cast<int>(index)]);
+  }
+
+  // converts the item at index with the stack reader of T, throws if incompatible
+  template <typename T>
+  T get(size_t index) const
+  {
+    if (index >= size())
+      throw std::runtime_error("variadic argument index " + std::to_string(index) + " out of range");
+
+    return stack::read_as<T>::get(my_perl, m_start + static_cast<int>(index), m_ax, m_items);
+  }
+
+  iterator begin() const noexcept { return { this, 0 }; }
+  iterator end() const noexcept { return { this, size() }; }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  int m_ax = 0;
+  int m_start = 0;
+  int m_items = 0;
+};
+
+// view of the remaining stack items of a call as key value pairs. lookups
+// search the pairs in reverse so later duplicate keys win like a perl hash
+struct kwargs
+{
+  struct iterator
+  {
+    bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+    iterator& operator++() { ++m_index; return *this; }
+    std::pair<const char*, scalar_ref> operator*() const
+    {
+      return { SvPV_nolen(m_kwargs->key_sv(m_index)), m_kwargs->value(m_index) };
+    }
+
+    // length of the current key (keys may contain embedded nulls)
+    std::size_t key_size() const
+    {
+      STRLEN len = 0;
+      SvPV(m_kwargs->key_sv(m_index), len);
+      return len;
+    }
+
+    PerlInterpreter* my_perl;
+    const kwargs* m_kwargs;
+    size_t m_index;
+  };
+
+  kwargs(PerlInterpreter* interp, int ax, int start, int items) noexcept
+    : my_perl(interp), m_ax(ax), m_start(start), m_items(items) {}
+
+  // number of key value pairs
+  size_t size() const { return static_cast<size_t>(m_items - m_start) / 2; }
+  bool empty() const  { return m_items == m_start; }
+
+  bool exists(const char* key) const        { return find(key, strlen(key)) >= 0; }
+  bool exists(const std::string& key) const { return find(key.c_str(), key.size()) >= 0; }
+
+  // returns the value of key, undef if it wasn't passed
+  scalar_ref operator[](const char* key) const        { return lookup(key, strlen(key)); }
+  scalar_ref operator[](const std::string& key) const { return lookup(key.c_str(), key.size()); }
+
+  // converts the value of key with the stack reader of T, throws if it wasn't
+  // passed or is incompatible
+  template <typename T>
+  T get(const std::string& key) const
+  {
+    int index = find(key.c_str(), key.size());
+    if (index < 0)
+      throw std::runtime_error("missing keyword argument '" + key + "'");
+
+    return stack::read_as<T>::get(my_perl, m_start + index * 2 + 1, m_ax, m_items);
+  }
+
+  // returns default_value if key wasn't passed
+  template <typename T>
+  T get(const std::string& key, T default_value) const
+  {
+    int index = find(key.c_str(), key.size());
+    if (index < 0)
+      return default_value;
+
+    return stack::read_as<T>::get(my_perl, m_start + index * 2 + 1, m_ax, m_items);
+  }
+
+  iterator begin() const noexcept { return { my_perl, this, 0 }; }
+  iterator end() const noexcept { return { my_perl, this, size() }; }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  SV* key_sv(size_t index) const { return PL_stack_base[m_ax + m_start + static_cast<int>(index) * 2]; }
+  scalar_ref value(size_t index) const
+  {
+    return scalar_ref(my_perl, PL_stack_base[m_ax + m_start + static_cast<int>(index) * 2 + 1]);
+  }
+
+  // returns index of the last pair with key or -1 if not found
+  int find(const char* key, size_t len) const
+  {
+    for (int index = static_cast<int>(size()) - 1; index >= 0; --index)
+    {
+      STRLEN key_len = 0;
+      const char* str = SvPV(key_sv(index), key_len);
+      if (key_len == len && std::memcmp(str, key, len) == 0)
+        return index;
+    }
+    return -1;
+  }
+
+  scalar_ref lookup(const char* key, size_t len) const
+  {
+    int index = find(key, len);
+    return index < 0 ? scalar_ref(my_perl, &PL_sv_undef) : value(index);
+  }
+
+  int m_ax = 0;
+  int m_start = 0;
+  int m_items = 0;
+};
+
+} // namespace perlbind
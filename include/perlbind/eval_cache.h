@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace perlbind { namespace detail {
+
+// least recently used cache of code evaluated by interpreter::eval compiled
+// once into anonymous subs (opt-in per interpreter). entries are keyed by a
+// hash of the source and verified against it on lookup
+class eval_cache
+{
+public:
+  static const char* key() { return "perlbind::eval_cache"; }
+
+  explicit eval_cache(PerlInterpreter* interp) : my_perl(interp) {}
+  eval_cache(const eval_cache&) = delete;
+  eval_cache& operator=(const eval_cache&) = delete;
+  ~eval_cache() { set_capacity(0); }
+
+  static eval_cache& get(PerlInterpreter* my_perl)
+  {
+    return interp_local<eval_cache>::get(my_perl);
+  }
+
+  // 64-bit FNV-1a
+  static std::uint64_t hash(const char* source, std::size_t len)
+  {
+    std::uint64_t value = 14695981039346656037ull;
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      value ^= static_cast<unsigned char>(source[i]);
+      value *= 1099511628211ull;
+    }
+    return value;
+  }
+
+  // returns false if source may not compile the same wrapped in a sub body
+  // (source ending at __END__ or __DATA__, or with pod)
+  static bool can_wrap(const char* source, std::size_t len)
+  {
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      if (source[i] == '_' && (std::strncmp(source + i, "__END__", 7) == 0 || std::strncmp(source + i, "__DATA__", 8) == 0))
+        return false;
+
+      bool line_start = i == 0 || source[i - 1] == '\n';
+      if (line_start && source[i] == '=' && i + 1 < len && std::isalpha(static_cast<unsigned char>(source[i + 1])))
+        return false;
+    }
+    return true;
+  }
+
+  std::size_t capacity() const { return m_capacity; }
+  std::size_t size() const { return m_entries.size(); }
+
+  // a capacity of 0 disables the cache, least recently used entries are freed
+  void set_capacity(std::size_t capacity)
+  {
+    m_capacity = capacity;
+    while (m_entries.size() > m_capacity)
+      evict();
+  }
+
+  // returns false if source isn't cached. cv is set to the compiled sub of
+  // source or nullptr if it's evaluated uncached (it doesn't compile as a sub)
+  bool find(const char* source, std::size_t len, std::uint64_t hash, CV*& cv)
+  {
+    auto it = m_index.find(hash);
+    if (it == m_index.end() || it->second->source.size() != len ||
+        std::memcmp(it->second->source.data(), source, len) != 0)
+    {
+      return false;
+    }
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    cv = it->second->cv;
+    return true;
+  }
+
+  // caches a new reference to cv (may be nullptr), replaces an entry with the same hash
+  void insert(const char* source, std::size_t len, std::uint64_t hash, CV* cv)
+  {
+    if (m_capacity == 0)
+      return;
+
+    auto it = m_index.find(hash);
+    if (it != m_index.end())
+    {
+      SvREFCNT_dec(it->second->cv);
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    }
+    else if (m_entries.size() >= m_capacity)
+    {
+      evict();
+    }
+
+    SvREFCNT_inc_simple_void(cv);
+    m_entries.push_front({ hash, std::string(source, len), cv });
+    m_index[hash] = m_entries.begin();
+  }
+
+private:
+  struct entry
+  {
+    std::uint64_t hash;
+    std::string source;
+    CV* cv;
+  };
+
+  void evict()
+  {
+    entry& last = m_entries.back();
+    SvREFCNT_dec(last.cv);
+    m_index.erase(last.hash);
+    m_entries.pop_back();
+  }
+
+  PerlInterpreter* my_perl = nullptr;
+  std::size_t m_capacity = 0;
+  std::list<entry> m_entries; // most recently used first
+  std::unordered_map<std::uint64_t, std::list<entry>::iterator> m_index;
+};
+
+} // namespace detail
+} // namespace perlbind
@@ -11,12 +11,28 @@ struct hash_iterator;
 
 } // namespace detail
 
+namespace stack {
+
+template <typename T, typename = void> struct read_as;
+
+} // namespace stack
+
 class interpreter;
 class package;
+class sub_handle;
+struct type_base;
+template <typename T> struct nullable;
+template <typename T> struct as_ref;
+template <typename T> struct by_value;
 struct scalar;
 struct scalar_proxy;
 struct reference;
 struct array;
 struct hash;
+struct scalar_ref;
+struct array_ref;
+struct hash_ref;
+struct args;
+struct kwargs;
 
 } // namespace perlbind
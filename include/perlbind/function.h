@@ -14,14 +14,18 @@ struct base_traits
   static constexpr int arity = sizeof...(Args);
   static constexpr int stack_arity = sizeof...(Args) + (std::is_void<Class>::value ? 0 : 1);
   static constexpr int vararg_count = count_of<array, Args...>::value +
-                                      count_of<hash, Args...>::value;
+                                      count_of<hash, Args...>::value +
+                                      count_of<args, Args...>::value +
+                                      count_of<kwargs, Args...>::value;
   static constexpr bool is_vararg = vararg_count > 0;
   static constexpr bool is_vararg_last = is_last<array, Args...>::value ||
-                                         is_last<hash, Args...>::value;
+                                         is_last<hash, Args...>::value ||
+                                         is_last<args, Args...>::value ||
+                                         is_last<kwargs, Args...>::value;
 
   static_assert(!is_vararg || (vararg_count == 1 && is_vararg_last),
-    "A function may only accept a single array or hash and it must be "
-    "be the last parameter. Prefer using reference parameters instead.");
+    "A function may only accept a single array, hash, args, or kwargs and it "
+    "must be the last parameter. Prefer using reference parameters instead.");
 };
 
 template <typename T, bool = std::is_class<T>::value>
@@ -51,35 +55,93 @@ struct function_traits<Ret(Class::*)(Args...) const, true> : base_traits<Ret, vo
   using type = Ret(*)(Args...);
 };
 
+// argument kind masks of a function's stack tuple built at compile time
+template <typename Tuple>
+struct arg_masks;
+
+template <typename... Args>
+struct arg_masks<std::tuple<Args...>>
+{
+  static constexpr bool exact = all_true<stack::arg_exact<Args>::value...>::value;
+
+  static const std::uint8_t* get()
+  {
+    static constexpr std::uint8_t masks[] = { stack::arg_mask<Args>::value..., 0 };
+    return masks;
+  }
+};
+
+// used by overload dispatch to match a function against classified stack kinds
+struct dispatch_info
+{
+  int arity = 0;          // expected stack items (ignored for varargs)
+  bool is_vararg = false;
+  bool is_exact = false;  // a mask match is sufficient for arguments to be compatible
+  const std::uint8_t* masks = nullptr;
+};
+
 // represents a bound native function
 struct function_base
 {
+  function_base() = delete;
+  function_base(dispatch_info info) : m_dispatch(info) {}
   virtual ~function_base() = default;
   virtual std::string get_signature() const = 0;
-  virtual bool is_compatible(xsub_stack&) const = 0;
+  // calls the function if arguments are compatible, returns false otherwise
+  virtual bool try_call(xsub_stack&) const = 0;
+  // calls the function, throws if arguments are incompatible
   virtual void call(xsub_stack&) const = 0;
 
-  static const MGVTBL mgvtbl;
+  const dispatch_info& dispatch() const { return m_dispatch; }
+  void set_return_policy(return_policy policy) { m_return_policy = policy; }
+
+protected:
+  dispatch_info m_dispatch;
+  return_policy m_return_policy = return_policy::automatic;
 };
 
+// function pointer or lambda stored by a function binding
 template <typename T>
+struct stored_target
+{
+  T get() const { return m_func; }
+  T m_func;
+};
+
+// function pointer known at compile time, calls through it can be inlined
+template <typename T, T Func>
+struct bound_target
+{
+  static constexpr T get() { return Func; }
+};
+
+template <typename T, typename Target = stored_target<T>>
 struct function : public function_base, function_traits<T>
 {
   using target_t = typename function::type;
   using return_t = typename function::return_t;
 
   function() = delete;
-  function(PerlInterpreter* interp, T func)
-    : my_perl(interp), m_func(func) {}
+  template <typename... Args>
+  function(PerlInterpreter* interp, Args&&... func)
+    : function_base(make_dispatch()), my_perl(interp), m_target{ std::forward<Args>(func)... } {}
 
   std::string get_signature() const override
   {
     return util::type_name<target_t>::str();
   };
 
-  bool is_compatible(xsub_stack& stack) const override
+  bool try_call(xsub_stack& stack) const override
   {
-    return function::is_vararg || stack.check_types(typename function::stack_tuple{});
+    if (!function::is_vararg && stack.size() != function::stack_arity)
+      return false;
+
+    staged_args args;
+    if (!stack.read_stack(args, false))
+      return false;
+
+    call_impl(stack, args, std::is_void<function::return_t>());
+    return true;
   }
 
   void call(xsub_stack& stack) const override
@@ -94,50 +156,90 @@ struct function : public function_base, function_traits<T>
       throw std::runtime_error(SvPV_nolen(err));
     }
 
-    call_impl(stack, std::is_void<function::return_t>());
+    staged_args args;
+    stack.read_stack(args, true); // throws on an incompatible argument
+    call_impl(stack, args, std::is_void<function::return_t>());
+  }
+
+  // xsub entry for a sub bound to only this function. the call is not virtual
+  // so argument conversion, the native call, and return push can be inlined
+  static void xsub(PerlInterpreter* my_perl, CV* cv)
+  {
+    // croak after unwinding so no C++ objects are left for croak to skip
+    SV* err = nullptr;
+    try
+    {
+      detail::xsub_stack stack(my_perl, cv);
+      static_cast<const function*>(CvXSUBANY(cv).any_ptr)->function::call(stack);
+      return;
+    }
+    catch (std::exception& e)
+    {
+      err = sv_2mortal(newSVpv(e.what(), 0));
+    }
+    catch (...)
+    {
+      err = sv_2mortal(newSVpv("unhandled exception", 0));
+    }
+    Perl_croak(aTHX_ "%s", SvPV_nolen(err));
   }
 
 private:
-  void call_impl(xsub_stack& stack, std::false_type) const
+  static dispatch_info make_dispatch()
+  {
+    using masks = arg_masks<typename function::stack_tuple>;
+
+    dispatch_info info;
+    info.arity = function::stack_arity;
+    info.is_vararg = function::is_vararg;
+    info.is_exact = masks::exact;
+    info.masks = masks::get();
+    return info;
+  }
+
+  using staged_args = typename stack::staged_tuple<typename function::stack_tuple>::type;
+
+  void call_impl(xsub_stack& stack, staged_args& args, std::false_type) const
   {
-    return_t result = apply(m_func, stack.convert_stack(typename function::stack_tuple{}));
-    stack.push_return(std::move(result));
+    return_t result = apply(m_target.get(), args);
+    stack.push_return(std::forward<return_t>(result), m_return_policy); // references stay lvalues
   }
 
-  void call_impl(xsub_stack& stack, std::true_type) const
+  void call_impl(xsub_stack& stack, staged_args& args, std::true_type) const
   {
-    apply(m_func, stack.convert_stack(typename function::stack_tuple{}));
+    apply(m_target.get(), args);
   }
 
   // c++14 call function template with tuple arg unpacking (c++17 can use std::apply())
+  // staged arguments are moved into the call since they're only read once
   template <typename F, typename Tuple, size_t... I>
   auto call_func(F func, Tuple&& t, std::index_sequence<I...>) const
   {
-    return func(std::get<I>(std::forward<Tuple>(t))...);
+    return func(std::move(std::get<I>(t).value())...);
   }
 
   template <typename F, typename Tuple, size_t... I>
   auto call_member(F method, Tuple&& t, std::index_sequence<I...>) const
   {
-    return (std::get<0>(t)->*method)(std::get<I + 1>(std::forward<Tuple>(t))...);
+    return (std::get<0>(t).value()->*method)(std::move(std::get<I + 1>(t).value())...);
   }
 
   template <typename F, typename Tuple, std::enable_if_t<!std::is_member_function_pointer<F>::value, bool> = true>
   auto apply(F func, Tuple&& t) const
   {
-    using make_sequence = std::make_index_sequence<std::tuple_size<Tuple>::value>;
+    using make_sequence = std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value>;
     return call_func(func, std::forward<Tuple>(t), make_sequence{});
   }
 
   template <typename F, typename Tuple, std::enable_if_t<std::is_member_function_pointer<F>::value, bool> = true>
   auto apply(F func, Tuple&& t) const
   {
-    using make_sequence = std::make_index_sequence<std::tuple_size<Tuple>::value - 1>;
+    using make_sequence = std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>::value - 1>;
     return call_member(func, std::forward<Tuple>(t), make_sequence{});
   }
 
   PerlInterpreter* my_perl = nullptr;
-  T m_func;
+  Target m_target;
 };
 
 } // namespace detail
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace perlbind { namespace detail { namespace handle {
+
+// typed handles attach ext magic to the referent of an object reference that
+// points to a header with the object pointer and the usertype id of its class
+// allocated with the magic (mg_len is its size so perl frees and copies it)
+// objects owned by perl point to a holder instead and set the owned flag
+// objects stored by value point to a payload allocated with the magic (freed by
+// perl) that has a header with the type id followed by the object
+
+constexpr U16 owned        = 1 << 0; // mg_private flags
+constexpr U16 inline_value = 1 << 1;
+constexpr U16 invalidated  = 1 << 2; // no object, see identity_map::invalidate
+
+struct pointer_header
+{
+  void* ptr;
+  std::size_t type_id;
+};
+
+// owner of a smart pointer pushed to perl, released when perl frees the object
+struct holder
+{
+  void* ptr;
+  std::size_t type_id;
+  std::shared_ptr<void> owner;
+};
+
+struct value_header
+{
+  void (*destroy)(void*); // nullptr if trivially destructible
+  std::size_t type_id;
+};
+
+constexpr std::size_t value_align = alignof(std::max_align_t);
+constexpr std::size_t value_offset = (sizeof(value_header) + value_align - 1) / value_align * value_align;
+
+template <typename T>
+void destroy_value(void* ptr) { static_cast<T*>(ptr)->~T(); }
+
+inline int free_handle(pTHX_ SV* sv, MAGIC* mg)
+{
+  if (mg->mg_private & inline_value)
+  {
+    // object is destroyed in place, perl frees the payload (mg_len > 0)
+    auto header = reinterpret_cast<value_header*>(mg->mg_ptr);
+    if (header->destroy)
+      header->destroy(mg->mg_ptr + value_offset);
+    return 0;
+  }
+
+  if (mg->mg_private & owned)
+  {
+    delete reinterpret_cast<holder*>(mg->mg_ptr);
+    mg->mg_ptr = nullptr;
+  }
+  return 0; // perl frees pointer headers (mg_len > 0)
+}
+
+inline const MGVTBL* vtbl()
+{
+  static const MGVTBL vtbl = { 0, 0, 0, 0, free_handle, 0, 0, 0 };
+  return &vtbl;
+}
+
+inline void attach(PerlInterpreter* my_perl, SV* obj, void* ptr, std::size_t type_id)
+{
+  pointer_header header{ ptr, type_id };
+  sv_magicext(obj, nullptr, PERL_MAGIC_ext, vtbl(), reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+// ownership of the smart pointer is given to the object referent
+inline void attach(PerlInterpreter* my_perl, SV* obj, void* ptr, std::size_t type_id, std::shared_ptr<void> owner)
+{
+  MAGIC* mg = sv_magicext(obj, nullptr, PERL_MAGIC_ext, vtbl(), nullptr, 0);
+  mg->mg_ptr = reinterpret_cast<char*>(new holder{ ptr, type_id, std::move(owner) });
+  mg->mg_private |= owned;
+}
+
+// marks an object referent without handle magic as no longer usable
+inline void attach_invalidated(PerlInterpreter* my_perl, SV* obj)
+{
+  MAGIC* mg = sv_magicext(obj, nullptr, PERL_MAGIC_ext, vtbl(), nullptr, 0);
+  mg->mg_private |= invalidated;
+}
+
+// constructs an object of type T in a payload owned by the object referent
+// returns a pointer to the object
+template <typename T, typename... Args>
+T* attach_value(PerlInterpreter* my_perl, SV* obj, std::size_t type_id, Args&&... args)
+{
+  static_assert(alignof(T) <= value_align, "over-aligned types cannot be stored by value");
+
+  char* payload = nullptr;
+  Newx(payload, value_offset + sizeof(T), char);
+
+  T* value = nullptr;
+  try
+  {
+    value = new (payload + value_offset) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    Safefree(payload);
+    throw;
+  }
+
+  new (payload) value_header{ std::is_trivially_destructible<T>::value ? nullptr : &destroy_value<T>, type_id };
+
+  MAGIC* mg = sv_magicext(obj, nullptr, PERL_MAGIC_ext, vtbl(), nullptr, 0);
+  mg->mg_ptr = payload;
+  mg->mg_len = static_cast<SSize_t>(value_offset + sizeof(T));
+  mg->mg_private |= inline_value;
+  return value;
+}
+
+// returns the handle magic of an object referent or nullptr if not a handle
+inline const MAGIC* find(PerlInterpreter* my_perl, SV* obj)
+{
+  return SvRMAGICAL(obj) ? mg_findext(obj, PERL_MAGIC_ext, vtbl()) : nullptr;
+}
+
+inline bool is_owned(const MAGIC* mg) { return (mg->mg_private & owned) != 0; }
+inline bool is_value(const MAGIC* mg) { return (mg->mg_private & inline_value) != 0; }
+inline bool is_invalidated(const MAGIC* mg) { return (mg->mg_private & invalidated) != 0; }
+
+inline std::size_t get_type_id(const MAGIC* mg)
+{
+  if (is_value(mg))
+    return reinterpret_cast<const value_header*>(mg->mg_ptr)->type_id;
+
+  if (is_owned(mg))
+    return reinterpret_cast<const holder*>(mg->mg_ptr)->type_id;
+
+  return reinterpret_cast<const pointer_header*>(mg->mg_ptr)->type_id;
+}
+
+inline void* get_ptr(const MAGIC* mg)
+{
+  if (is_value(mg))
+    return mg->mg_ptr + value_offset;
+
+  if (is_owned(mg))
+    return reinterpret_cast<holder*>(mg->mg_ptr)->ptr;
+
+  return reinterpret_cast<const pointer_header*>(mg->mg_ptr)->ptr;
+}
+
+// returns owner of an object held by perl or nullptr if not owned
+inline const std::shared_ptr<void>* get_owner(const MAGIC* mg)
+{
+  return is_owned(mg) ? &reinterpret_cast<holder*>(mg->mg_ptr)->owner : nullptr;
+}
+
+} // namespace handle
+} // namespace detail
+} // namespace perlbind
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace perlbind { namespace detail {
+
+// sets sv to a new reference to an existing object referent
+inline void set_ref(PerlInterpreter* my_perl, SV* sv, SV* obj)
+{
+  if (SvTYPE(sv) == SVt_NULL)
+  {
+    // new mortals are upgraded in place, avoids a temporary reference
+    sv_upgrade(sv, SVt_IV);
+    SvRV_set(sv, SvREFCNT_inc_simple_NN(obj));
+    SvROK_on(sv);
+  }
+  else
+  {
+    SV* ref = newRV_inc(obj);
+    sv_setsv(sv, ref);
+    SvREFCNT_dec(ref);
+  }
+}
+
+// objects of identity mapped types pushed per interpreter, keyed by pointer
+// entries hold weak references so perl still frees objects with no references
+// left. freed entries are reused on the next push or swept as the map grows
+class identity_map
+{
+public:
+  static const char* key() { return "perlbind::identity_map"; }
+
+  explicit identity_map(PerlInterpreter* interp) : my_perl(interp) {}
+  identity_map(const identity_map&) = delete;
+  identity_map& operator=(const identity_map&) = delete;
+  ~identity_map()
+  {
+    for (auto& it : m_objects)
+      SvREFCNT_dec(it.second.weak);
+  }
+
+  static identity_map& get(PerlInterpreter* my_perl)
+  {
+    return interp_local<identity_map>::get(my_perl);
+  }
+
+  // returns live object referent stored for the pointer and type or nullptr
+  SV* find(const void* ptr, std::size_t type_id) const
+  {
+    auto it = m_objects.find(ptr);
+    if (it != m_objects.end() && it->second.type_id == type_id && SvROK(it->second.weak))
+      return SvRV(it->second.weak);
+
+    return nullptr;
+  }
+
+  void insert(const void* ptr, std::size_t type_id, SV* obj)
+  {
+    if (m_objects.size() >= m_sweep_size)
+      sweep();
+
+    SV* weak = newRV_inc(obj);
+    sv_rvweaken(weak);
+
+    entry& object = m_objects[ptr];
+    SvREFCNT_dec(object.weak);
+    object = { weak, type_id };
+  }
+
+  // removes the pointer from the map. a live object for it has its pointer
+  // cleared and its handle magic replaced with an invalidated marker so it's
+  // no longer usable as the pointer's type
+  bool invalidate(const void* ptr)
+  {
+    auto it = m_objects.find(ptr);
+    if (it == m_objects.end())
+      return false;
+
+    SV* weak = it->second.weak;
+    if (SvROK(weak))
+    {
+      SV* obj = SvRV(weak);
+      sv_unmagicext(obj, PERL_MAGIC_ext, const_cast<MGVTBL*>(handle::vtbl()));
+      handle::attach_invalidated(my_perl, obj);
+      sv_setiv(obj, 0);
+    }
+
+    SvREFCNT_dec(weak);
+    m_objects.erase(it);
+    return true;
+  }
+
+  std::size_t size() const { return m_objects.size(); }
+
+private:
+  struct entry
+  {
+    SV* weak = nullptr;
+    std::size_t type_id = 0;
+  };
+
+  // removes entries of objects freed by perl
+  void sweep()
+  {
+    for (auto it = m_objects.begin(); it != m_objects.end();)
+    {
+      if (SvROK(it->second.weak))
+      {
+        ++it;
+      }
+      else
+      {
+        SvREFCNT_dec(it->second.weak);
+        it = m_objects.erase(it);
+      }
+    }
+    m_sweep_size = std::max<std::size_t>(min_sweep_size, m_objects.size() * 2);
+  }
+
+  static constexpr std::size_t min_sweep_size = 64;
+
+  PerlInterpreter* my_perl = nullptr;
+  std::size_t m_sweep_size = min_sweep_size;
+  std::unordered_map<const void*, entry> m_objects;
+};
+
+} // namespace detail
+} // namespace perlbind
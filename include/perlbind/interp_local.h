@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+namespace perlbind { namespace detail {
+
+// native data of type T stored per interpreter in PL_modglobal. it's created on
+// first use and deleted by magic when perl frees PL_modglobal on destruction
+// T must provide a static key() with a unique name for its modglobal entry and
+// is constructed with the interpreter if it has a PerlInterpreter* constructor
+template <typename T>
+struct interp_local
+{
+  static T& get(PerlInterpreter* my_perl)
+  {
+    // the last lookup is cached, hosts rarely switch between interpreters. caches
+    // on every thread are invalidated when data is freed since a new interpreter
+    // may be allocated at the address of a destroyed one
+    cache_entry& cached = cache();
+    std::size_t generation = free_generation.load(std::memory_order_acquire);
+    if (cached.interp != my_perl || cached.generation != generation)
+    {
+      cached.interp = my_perl;
+      cached.generation = generation;
+      cached.data = fetch(my_perl);
+    }
+    return *cached.data;
+  }
+
+private:
+  struct cache_entry
+  {
+    PerlInterpreter* interp = nullptr;
+    std::size_t generation = 0;
+    T* data = nullptr;
+  };
+
+  static cache_entry& cache()
+  {
+    static thread_local cache_entry cached;
+    return cached;
+  }
+
+  static T* fetch(PerlInterpreter* my_perl)
+  {
+    const char* key = T::key();
+    I32 len = static_cast<I32>(strlen(key));
+
+    SV** svp = hv_fetch(PL_modglobal, key, len, 0);
+    if (svp)
+    {
+      MAGIC* mg = mg_findext(*svp, PERL_MAGIC_ext, &mgvtbl);
+      return reinterpret_cast<T*>(mg->mg_ptr);
+    }
+
+    T* data = create(my_perl);
+    SV* sv = newSV(0);
+    sv_magicext(sv, nullptr, PERL_MAGIC_ext, &mgvtbl, reinterpret_cast<const char*>(data), 0);
+    hv_store(PL_modglobal, key, len, sv, 0);
+    return data;
+  }
+
+  template <typename U = T, std::enable_if_t<std::is_constructible<U, PerlInterpreter*>::value, bool> = true>
+  static T* create(PerlInterpreter* my_perl) { return new T(my_perl); }
+
+  template <typename U = T, std::enable_if_t<!std::is_constructible<U, PerlInterpreter*>::value, bool> = true>
+  static T* create(PerlInterpreter* my_perl) { return new T(); }
+
+  static int free_data(pTHX_ SV* sv, MAGIC* mg)
+  {
+    free_generation.fetch_add(1, std::memory_order_release);
+    delete reinterpret_cast<T*>(mg->mg_ptr);
+    return 1;
+  }
+
+  static const MGVTBL mgvtbl;
+  static std::atomic<std::size_t> free_generation;
+};
+
+template <typename T>
+const MGVTBL interp_local<T>::mgvtbl = { 0, 0, 0, 0, interp_local<T>::free_data, 0, 0, 0 };
+
+template <typename T>
+std::atomic<std::size_t> interp_local<T>::free_generation{ 0 };
+
+} // namespace detail
+} // namespace perlbind
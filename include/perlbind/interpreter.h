@@ -19,6 +19,19 @@ public:
   void load_script(std::string packagename, std::string filename);
   void eval(const char* str);
 
+  // compiles code once into an anonymous sub, returns a handle to call it
+  // throws on compile errors
+  sub_handle compile(const std::string& code);
+
+  // caches code evaluated by eval() compiled into anonymous subs so repeated
+  // evals of the same code aren't parsed again, up to max_entries least
+  // recently used entries. code that defines named subs or has BEGIN blocks
+  // only runs those once. 0 disables it and frees the cached subs
+  void use_eval_cache(std::size_t max_entries = 256)
+  {
+    detail::eval_cache::get(my_perl).set_capacity(max_entries);
+  }
+
   template <typename T, typename... Args>
   T call_sub(const char* subname, Args&&... args) const
   {
@@ -26,6 +39,62 @@ public:
     return caller.call_sub<T>(subname, std::forward<Args>(args)...);
   }
 
+  // returns a handle that calls subname through its cached CV
+  sub_handle get_sub(std::string subname) const
+  {
+    return sub_handle(my_perl, std::move(subname));
+  }
+
+  // calls a sub once per item of a range with the item aliased to $_ or @_
+  // perl subs are run with MULTICALL which reuses one call frame for all items
+  // func(item, result) is called with each converted return value (func(item)
+  // if T is void). throws if the sub dies or func throws, which ends the loop
+  template <typename T, typename Range, typename Func>
+  void multicall(sub_handle& sub, const Range& items, Func&& func, multicall_arg arg = multicall_arg::topic) const
+  {
+    multicall_impl<T>(sub.cv(), sub.name().c_str(), items, func, arg);
+  }
+
+  template <typename T, typename Range, typename Func>
+  void multicall(const char* subname, const Range& items, Func&& func, multicall_arg arg = multicall_arg::topic) const
+  {
+    multicall_impl<T>(get_cv(subname, 0), subname, items, func, arg);
+  }
+
+  // calls each sub with its arguments in void context under one scope instead
+  // of a scope per call. mortals are freed after every freetmps_interval calls
+  // (only at the end if 0). calls that die or can't be made don't stop the
+  // batch, their errors are returned in call order
+  template <typename... Args>
+  std::vector<batch_error> call_batch(const std::vector<std::pair<sub_handle*, std::tuple<Args...>>>& calls,
+                                      std::size_t freetmps_interval = 32) const
+  {
+    std::vector<batch_error> errors;
+    detail::sub_caller caller(my_perl, gv_fetchpvs("@", GV_ADD, SVt_PV));
+
+    for (std::size_t i = 0; i < calls.size(); ++i)
+    {
+      try
+      {
+        sub_handle& sub = *calls[i].first;
+        CV* cv = sub.cv();
+        if (!cv)
+          throw std::runtime_error("Perl error: Undefined subroutine &" + sub.name() + " called");
+
+        call_batch_impl(caller, cv, calls[i].second, std::index_sequence_for<Args...>());
+      }
+      catch (std::exception& e)
+      {
+        errors.push_back({ i, e.what() });
+      }
+
+      if (freetmps_interval && (i + 1) % freetmps_interval == 0)
+        caller.free_temps();
+    }
+
+    return errors;
+  }
+
   // returns interface to add bindings to package name
   package new_package(const char* name)
   {
@@ -39,22 +108,66 @@ public:
     static_assert(!std::is_pointer<T>::value && !std::is_reference<T>::value,
                   "new_class<T> 'T' should not be a pointer or reference");
 
-    auto typemap = detail::typemap::get(my_perl);
-    auto type_id = detail::usertype<T*>::id();
-    typemap[type_id] = name;
+    detail::typemap::add<T*>(my_perl, name);
 
     return class_<T>(my_perl, name);
   }
 
+  // removes a destroyed object's pointer from the identity map, returns false
+  // if it wasn't mapped. perl objects still referencing it become unusable
+  bool invalidate_object(const void* ptr)
+  {
+    return detail::identity_map::get(my_perl).invalidate(ptr);
+  }
+
+  // interns strings returned by const reference from bindings so returns of
+  // the same long-lived strings share one perl string buffer (copy-on-write)
+  // disabling it releases the interned strings
+  void use_string_interning(bool enable = true)
+  {
+    detail::string_cache::get(my_perl).set_enabled(enable);
+  }
+
   // helper to bind functions in default main:: package
   template <typename T>
-  void add(const char* name, T&& func)
+  void add(const char* name, T&& func, return_policy policy = return_policy::automatic)
   {
-    new_package("main").add(name, std::forward<T>(func));
+    new_package("main").add(name, std::forward<T>(func), policy);
   }
 
+  template <typename T, T Func>
+  void add(const char* name, return_policy policy = return_policy::automatic)
+  {
+    new_package("main").add<T, Func>(name, policy);
+  }
+
+#ifdef __cpp_nontype_template_parameter_auto
+  template <auto Func>
+  void add(const char* name, return_policy policy = return_policy::automatic)
+  {
+    new_package("main").add<Func>(name, policy);
+  }
+#endif
+
 private:
   void init(int argc, const char** argv);
+  void eval_source(const char* str);
+
+  template <typename... Args, std::size_t... I>
+  static void call_batch_impl(detail::sub_caller& caller, CV* cv, const std::tuple<Args...>& args, std::index_sequence<I...>)
+  {
+    caller.call_sub<void>(cv, std::get<I>(args)...);
+  }
+
+  template <typename T, typename Range, typename Func>
+  void multicall_impl(CV* cv, const char* subname, const Range& items, Func& func, multicall_arg arg) const
+  {
+    if (!cv || (!CvISXSUB(cv) && !CvROOT(cv)))
+      throw std::runtime_error("Perl error: Undefined subroutine &" + std::string(subname) + " called");
+
+    detail::multicall_loop<T, Range, Func> loop(my_perl, cv, items, func, arg);
+    detail::multicall_runner::run(my_perl, loop);
+  }
 
   bool m_is_owner = false;
   PerlInterpreter* my_perl = nullptr;
@@ -83,17 +83,30 @@ struct hash_iterator
     return m_pair;
   }
 
+  // length of the current key (keys may contain embedded nulls)
+  std::size_t key_size() const { return m_key_size; }
+
+#ifdef __cpp_lib_string_view
+  std::string_view key() const { return std::string_view(m_pair.first, m_key_size); }
+#endif
+
 private:
   void fetch()
   {
     if (m_he)
-      m_pair = { HePV(m_he, PL_na), scalar(my_perl, SvREFCNT_inc(HeVAL(m_he))) };
+    {
+      STRLEN len = 0;
+      const char* key = HePV(m_he, len);
+      m_pair = { key, scalar(my_perl, SvREFCNT_inc(HeVAL(m_he))) };
+      m_key_size = len;
+    }
   }
 
   PerlInterpreter* my_perl;
   HV* m_hv;
   HE* m_he;
   std::pair<const char*, scalar> m_pair;
+  std::size_t m_key_size = 0;
 };
 
 } // namespace detail
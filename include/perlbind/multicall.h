@@ -0,0 +1,244 @@
+#pragma once
+
+#include <exception>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace perlbind { namespace detail {
+
+// a multicall loop runs a perl sub for each item of a range without setting up
+// a new sub call frame per item (the same as List::Util). perl can't catch a
+// die in a multicall so loops are run by an xsub called with an eval scope.
+// loops must not have C++ objects alive while perl code runs since a die
+// longjmps past them, errors thrown by native code are rethrown after the loop
+struct multicall_base : stack::pusher
+{
+  multicall_base(PerlInterpreter* my_perl, CV* cv) : stack::pusher(my_perl), m_cv(cv) {}
+  virtual void run() = 0;
+
+  CV* m_cv = nullptr;
+  std::exception_ptr m_error;
+};
+
+// anonymous xsub per interpreter that runs the loop in its any_ptr
+class multicall_runner
+{
+public:
+  static const char* key() { return "perlbind::multicall_runner"; }
+
+  explicit multicall_runner(PerlInterpreter* interp) : my_perl(interp)
+  {
+    m_cv = newXS(nullptr, &multicall_runner::xsub, __FILE__);
+  }
+  multicall_runner(const multicall_runner&) = delete;
+  multicall_runner& operator=(const multicall_runner&) = delete;
+  ~multicall_runner() { SvREFCNT_dec(m_cv); }
+
+  // runs loop, throws if the sub dies or native code threw during the loop
+  static void run(PerlInterpreter* my_perl, multicall_base& loop)
+  {
+    CV* cv = interp_local<multicall_runner>::get(my_perl).m_cv;
+    void* prev = CvXSUBANY(cv).any_ptr; // loops may be nested
+    CvXSUBANY(cv).any_ptr = &loop;
+
+    try
+    {
+      sub_caller caller(my_perl);
+      caller.call_sub<void>(cv);
+    }
+    catch (...)
+    {
+      CvXSUBANY(cv).any_ptr = prev;
+      throw;
+    }
+
+    CvXSUBANY(cv).any_ptr = prev;
+    if (loop.m_error)
+      std::rethrow_exception(loop.m_error);
+  }
+
+private:
+  static void xsub(PerlInterpreter* my_perl, CV* cv)
+  {
+    dXSARGS;
+    PERL_UNUSED_VAR(items);
+    static_cast<multicall_base*>(CvXSUBANY(cv).any_ptr)->run();
+    XSRETURN_EMPTY;
+  }
+
+  PerlInterpreter* my_perl = nullptr;
+  CV* m_cv = nullptr;
+};
+
+template <typename T, typename Range, typename Func>
+class multicall_loop : public multicall_base
+{
+public:
+  using item_t = typename std::iterator_traits<decltype(std::begin(std::declval<const Range&>()))>::value_type;
+
+  multicall_loop(PerlInterpreter* my_perl, CV* cv, const Range& items, Func& func, multicall_arg arg)
+    : multicall_base(my_perl, cv), m_items(items), m_func(func), m_arg(arg) {}
+
+  void run() override
+  {
+    U8 gimme = std::is_void<T>::value ? G_VOID : G_SCALAR;
+
+    ENTER;
+    if (m_arg == multicall_arg::topic)
+      SAVESPTR(GvSV(PL_defgv));
+    else
+      m_defav = save_ary(PL_defgv); // local @_
+
+    if (CvISXSUB(m_cv))
+      run_calls(gimme);
+    else
+      run_multicall(gimme);
+
+    LEAVE;
+  }
+
+private:
+  void run_multicall(U8 gimme)
+  {
+    dMULTICALL;
+    PUSH_MULTICALL(m_cv);
+
+    for (auto it = std::begin(m_items); it != std::end(m_items); ++it)
+    {
+      // temps and the sub's saved values are freed per item like grep does
+      ENTER;
+      SAVETMPS;
+      bool result = set_item(*it);
+      if (result)
+      {
+        MULTICALL;
+        result = consume(*it, PL_stack_sp);
+      }
+      FREETMPS;
+      LEAVE;
+
+      if (!result)
+        break;
+    }
+
+    POP_MULTICALL;
+  }
+
+  // xsubs are called normally
+  void run_calls(U8 gimme)
+  {
+    for (auto it = std::begin(m_items); it != std::end(m_items); ++it)
+    {
+      ENTER;
+      SAVETMPS;
+      sp = PL_stack_sp;
+      PUSHMARK(sp);
+      bool result = m_arg == multicall_arg::args ? push_item(*it) : set_item(*it);
+      if (result)
+      {
+        PUTBACK;
+        int count = call_sv(reinterpret_cast<SV*>(m_cv), gimme);
+        SPAGAIN;
+        result = consume(*it, count > 0 ? sp : nullptr);
+        sp -= count;
+        PUTBACK;
+      }
+      FREETMPS;
+      LEAVE;
+
+      if (!result)
+        break;
+    }
+  }
+
+  // pushes item as call arguments above the stack top
+  bool push_item(const item_t& item)
+  {
+    try
+    {
+      push_args(item);
+      return true;
+    }
+    catch (...)
+    {
+      m_error = std::current_exception();
+      return false;
+    }
+  }
+
+  // aliases $_ or @_ to the item's converted values (in the item's scope)
+  bool set_item(const item_t& item)
+  {
+    SSize_t base = PL_stack_sp - PL_stack_base;
+    sp = PL_stack_sp;
+    if (!push_item(item))
+      return false;
+
+    SV** first = PL_stack_base + base + 1;
+    SSize_t count = sp - first + 1;
+    sp = PL_stack_base + base;
+
+    if (m_arg == multicall_arg::topic)
+    {
+      SV* sv = &PL_sv_undef;
+      if (count > 0)
+      {
+        // held until the item's scope is left since the sub's statements free temps
+        sv = SvREFCNT_inc_simple_NN(*first);
+        SAVEFREESV(sv);
+        SvTEMP_off(sv); // prevents perl stealing its buffer when $_ is copied
+      }
+      GvSV(PL_defgv) = sv;
+    }
+    else
+    {
+      av_clear(m_defav);
+      av_extend(m_defav, count);
+      for (SSize_t i = 0; i < count; ++i)
+        av_push(m_defav, SvREFCNT_inc(first[i]));
+    }
+    return true;
+  }
+
+  // passes the returned value to func, returns false if it threw
+  bool consume(const item_t& item, SV** result)
+  {
+    try
+    {
+      call_func(item, result, std::is_void<T>());
+      return true;
+    }
+    catch (...)
+    {
+      m_error = std::current_exception();
+      return false;
+    }
+  }
+
+  void call_func(const item_t& item, SV** result, std::true_type)
+  {
+    m_func(item);
+  }
+
+  void call_func(const item_t& item, SV** result, std::false_type)
+  {
+    if (!result)
+      result = &PL_stack_base[0]; // always undef
+
+    // values held by perl types are copied since a multicall sub's return
+    // value may be its own pad value reused by the next call
+    if (std::is_base_of<type_base, T>::value && result != PL_stack_base)
+      *result = sv_mortalcopy(*result);
+
+    m_func(item, stack::get_scalar_return<T>(my_perl, static_cast<int>(result - PL_stack_base)));
+  }
+
+  const Range& m_items;
+  Func& m_func;
+  multicall_arg m_arg;
+  AV* m_defav = nullptr;
+};
+
+} // namespace detail
+} // namespace perlbind
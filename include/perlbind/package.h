@@ -16,14 +16,37 @@ public:
   // bind a function pointer to a function name in the package
   // overloads with same name must be explicit (default parameters not supported)
   // overloads have a runtime lookup cost and chooses the first compatible overload
+  // the return policy controls how the return value is pushed per context
   template <typename T>
-  void add(const char* name, T func)
+  void add(const char* name, T func, return_policy policy = return_policy::automatic)
   {
-    // ownership of function object is given to perl
+    // ownership of function object is given to the sub's overload set
     auto function = new detail::function<T>(my_perl, func);
-    add_impl(name, static_cast<detail::function_base*>(function));
+    function->set_return_policy(policy);
+    add_impl(name, static_cast<detail::function_base*>(function), &detail::function<T>::xsub);
   }
 
+  // bind a function pointer known at compile time, the sub's xsub calls it
+  // directly instead of through a stored pointer so the call can be inlined
+  // c++14: add<decltype(&func), &func>(name)
+  template <typename T, T Func>
+  void add(const char* name, return_policy policy = return_policy::automatic)
+  {
+    using function_t = detail::function<T, detail::bound_target<T, Func>>;
+    auto function = new function_t(my_perl);
+    function->set_return_policy(policy);
+    add_impl(name, static_cast<detail::function_base*>(function), &function_t::xsub);
+  }
+
+#ifdef __cpp_nontype_template_parameter_auto
+  // c++17: add<&func>(name)
+  template <auto Func>
+  void add(const char* name, return_policy policy = return_policy::automatic)
+  {
+    add<decltype(Func), Func>(name, policy);
+  }
+#endif
+
   // specify a base class name for object inheritance (must be registered)
   // calling object methods missing from the package will search parent classes
   // base classes are searched in registered order and include any grandparents
@@ -33,6 +56,7 @@ public:
     AV* av = get_av(package_isa.c_str(), GV_ADD);
     array isa_array = reinterpret_cast<AV*>(SvREFCNT_inc(av));
     isa_array.push_back(name);
+    detail::typemap::get(my_perl).invalidate();
   }
 
   // add a constant value to this package namespace
@@ -42,18 +66,36 @@ public:
     newCONSTSUB(m_stash, name, scalar(value).release());
   }
 
-private:
-  void add_impl(const char* name, detail::function_base* function);
-
+protected:
   std::string m_name;
   PerlInterpreter* my_perl = nullptr;
   HV* m_stash = nullptr;
+
+private:
+  // the xsub entry is used while the sub has a single function
+  void add_impl(const char* name, detail::function_base* function, XSUBADDR_t xsub);
 };
 
 template <typename T>
 struct class_ : public package
 {
   using package::package;
+
+  // objects of this class are pushed as typed handles (ext magic holding the
+  // object pointer and type id). handles are verified without name lookups
+  // and blessed references not created by perlbind are rejected as arguments
+  void use_typed_handles(bool enabled = true)
+  {
+    detail::typemap::get(my_perl).set_typed_handles(detail::usertype<T*>::id(), enabled);
+  }
+
+  // pushing a pointer of this class returns the same perl object while a
+  // previous object for the pointer is still referenced in perl. the host must
+  // call interpreter::invalidate_object when destroying an object that's mapped
+  void use_identity_map(bool enabled = true)
+  {
+    detail::typemap::get(my_perl).set_identity_map(detail::usertype<T*>::id(), enabled);
+  }
 };
 
 } // namespace perlbind
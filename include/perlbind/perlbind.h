@@ -45,11 +45,19 @@
 #include <perlbind/util.h>
 #include <perlbind/traits.h>
 #include <perlbind/hash.h>
+#include <perlbind/interp_local.h>
+#include <perlbind/handle.h>
+#include <perlbind/identity_map.h>
+#include <perlbind/string_cache.h>
+#include <perlbind/eval_cache.h>
 #include <perlbind/typemap.h>
 #include <perlbind/scalar.h>
 #include <perlbind/array.h>
+#include <perlbind/borrowed.h>
 #include <perlbind/stack.h>
 #include <perlbind/subcaller.h>
+#include <perlbind/sub_handle.h>
+#include <perlbind/multicall.h>
 #include <perlbind/function.h>
 #include <perlbind/package.h>
 #include <perlbind/interpreter.h>
@@ -34,6 +34,10 @@ struct scalar : type_base
     : type_base(), m_sv(newSVpv(value, 0)) {}
   scalar(const std::string& value) noexcept
     : type_base(), m_sv(newSVpvn(value.c_str(), value.size())) {}
+#ifdef __cpp_lib_string_view
+  scalar(std::string_view value) noexcept
+    : type_base(), m_sv(newSVpvn(value.data(), value.size())) {}
+#endif
 
   template <typename T, std::enable_if_t<detail::is_signed_integral_or_enum<T>::value, bool> = true>
   scalar(T value) noexcept : type_base(), m_sv(newSViv(static_cast<IV>(value))) {}
@@ -90,6 +94,14 @@ struct scalar : type_base
     return *this;
   }
 
+#ifdef __cpp_lib_string_view
+  scalar& operator=(std::string_view value) noexcept
+  {
+    sv_setpvn(m_sv, value.data(), value.size());
+    return *this;
+  }
+#endif
+
   template <typename T, std::enable_if_t<detail::is_signed_integral_or_enum<T>::value, bool> = true>
   scalar& operator=(T value) noexcept
   {
@@ -115,15 +127,29 @@ struct scalar : type_base
   scalar& operator=(T value) noexcept
   {
     // bless if it's in the typemap
-    const char* type_name = detail::typemap::template get_name<T>(my_perl);
-    sv_setref_pv(m_sv, type_name, static_cast<void*>(value));
+    if (!detail::typemap::template set_object<T>(my_perl, m_sv, value))
+      sv_setiv(newSVrv(m_sv, nullptr), PTR2IV(value));
     return *this;
   }
 
   operator SV*() const { return m_sv; }
   operator void*() const { return m_sv; }
   operator const char*() const { return SvPV_nolen(m_sv); }
-  operator std::string() const { return SvPV_nolen(m_sv); }
+  operator std::string() const
+  {
+    STRLEN len = 0;
+    const char* str = SvPV(m_sv, len);
+    return std::string(str, len);
+  }
+#ifdef __cpp_lib_string_view
+  // views the string buffer of the SV, invalidated if the SV is modified
+  operator std::string_view() const
+  {
+    STRLEN len = 0;
+    const char* str = SvPV(m_sv, len);
+    return std::string_view(str, len);
+  }
+#endif
   template <typename T, std::enable_if_t<detail::is_signed_integral_or_enum<T>::value, bool> = true>
   operator T() const { return static_cast<T>(SvIV(m_sv)); }
   template <typename T, std::enable_if_t<std::is_unsigned<T>::value, bool> = true>
@@ -133,13 +159,9 @@ struct scalar : type_base
   template <typename T, std::enable_if_t<std::is_pointer<T>::value, bool> = true>
   operator T() const
   {
-    const char* type_name = detail::typemap::template get_name<T>(my_perl);
-    if (type_name && sv_isobject(m_sv) && sv_derived_from(m_sv, type_name))
-    {
-      IV tmp = SvIV(SvRV(m_sv));
-      return INT2PTR(T, tmp);
-    }
-    return nullptr;
+    T value = nullptr;
+    detail::typemap::template get_object<T>(my_perl, m_sv, value);
+    return value;
   }
 
   template <typename T>
@@ -216,6 +238,9 @@ struct scalar_proxy
   T as() const { return m_value.as<T>(); }
 
   operator std::string() const { return m_value; }
+#ifdef __cpp_lib_string_view
+  operator std::string_view() const { return m_value; }
+#endif
 
   // copying value to supported conversion types (e.g. int val = arr[i])
   template <typename T, std::enable_if_t<!std::is_base_of<type_base, T>::value, bool> = true>
@@ -37,29 +37,63 @@ public:
   void push_return(T&& value)
   {
     XSprePUSH;
-    push(std::forward<T>(value));
+    push_return_impl(std::forward<T>(value), return_kind<std::decay_t<T>>());
   }
 
-  // returns true if all perl stack arguments are compatible with expected native arg types
-  template <typename Tuple>
-  bool check_types(Tuple&& types)
+  template <typename T>
+  void push_return(T&& value, return_policy policy)
   {
-    static constexpr int count = std::tuple_size<Tuple>::value;
-    if (items != count)
-      return false;
-    else if (count == 0)
-      return true;
+    if (policy != return_policy::automatic && gimme() == G_VOID)
+      return;
+
+    push_return(std::forward<T>(value), policy, is_list_return<std::decay_t<T>>());
+  }
+
+  // strings returned by const reference are long-lived and may be interned
+  void push_return(const std::string& value)
+  {
+    XSprePUSH;
+    string_cache& cache = string_cache::get(my_perl);
+    SV* sv = cache.enabled() ? cache.intern(value) : nullptr;
+    if (!sv)
+    {
+      push_return_impl(value, target_return());
+      return;
+    }
+
+#ifdef PERLBIND_COW_FLAGS
+    dXSTARG;
+    sv_setsv_flags(targ, sv, PERLBIND_COW_FLAGS); // perl copies short strings into an existing buffer
+    PUSHTARG;
+#else
+    PUSHs(sv);
+#endif
+    ++m_pushed;
+  }
 
-    using make_sequence = std::make_index_sequence<count>;
-    return check_stack(std::forward<Tuple>(types), make_sequence());
+  // converts perl stack arguments into a tuple of staged values in a single
+  // check and convert pass. returns false on the first incompatible argument
+  // or throws the argument reader's error if strict
+  template <typename... Args>
+  bool read_stack(std::tuple<stack::staged<Args>...>& args, bool strict)
+  {
+    using make_sequence = std::index_sequence_for<Args...>;
+    return read_stack(args, strict, make_sequence());
   }
 
-  // returns tuple of converted perl stack arguments, throws on an incompatible type
-  template <typename Tuple>
-  auto convert_stack(Tuple&& types)
+  // stores kind flags of the first count stack items, returns false if an item
+  // has get magic since its flags aren't valid until the magic is called
+  bool get_kinds(std::uint8_t* kinds, int count) const
   {
-    using make_sequence = std::make_index_sequence<std::tuple_size<Tuple>::value>;
-    return get_stack(std::forward<Tuple>(types), make_sequence());
+    for (int i = 0; i < count; ++i)
+    {
+      SV* sv = ST(i);
+      if (SvGMAGICAL(sv))
+        return false;
+
+      kinds[i] = stack::classify(sv);
+    }
+    return true;
   }
 
   std::string types()
@@ -75,11 +109,138 @@ public:
   }
 
 protected:
+  // single number and string returns are written to the calling op's target
+  // (dXSTARG) like core xsubs instead of allocating a new mortal each call
+  template <typename T>
+  struct is_target_scalar : std::integral_constant<bool,
+    ((std::is_arithmetic<T>::value || std::is_enum<T>::value) && !std::is_same<T, bool>::value) ||
+    is_any<T, std::string, const char*>::value || is_string_view<T>::value> {};
+
+  struct value_return {};
+  struct target_return {};
+  struct list_return {};
+
+  template <typename T>
+  using return_kind = std::conditional_t<is_target_scalar<T>::value, target_return,
+                      std::conditional_t<is_tuple<T>::value, list_return, value_return>>;
+
+  template <typename T>
+  void push_return_impl(T&& value, value_return)
+  {
+    push(std::forward<T>(value));
+  }
+
+  // pairs and tuples return multiple values, in scalar context only the last
+  // element is returned like a perl list
+  template <typename T>
+  void push_return_impl(const T& value, list_return)
+  {
+    if (gimme() == G_SCALAR)
+      push_last(value, std::integral_constant<std::size_t, std::tuple_size<T>::value>());
+    else
+      push_list(value);
+  }
+
+  template <typename T>
+  void push_last(const T& value, std::integral_constant<std::size_t, 0>)
+  {
+    PUSHs(&PL_sv_undef);
+    ++m_pushed;
+  }
+
+  template <typename T, std::size_t N>
+  void push_last(const T& value, std::integral_constant<std::size_t, N>)
+  {
+    push_element(std::get<N - 1>(value));
+  }
+
+  template <typename T>
+  struct is_list_return : std::integral_constant<bool, is_container<T>::value || is_any<T, array, hash>::value> {};
+
+  template <typename T>
+  void push_return(T&& value, return_policy policy, std::false_type)
+  {
+    push_return(std::forward<T>(value));
+  }
+
+  template <typename T>
+  void push_return(T&& value, return_policy policy, std::true_type)
+  {
+    bool is_scalar_policy = policy == return_policy::count || policy == return_policy::reference;
+    if (!is_scalar_policy || gimme() != G_SCALAR)
+    {
+      push_return(std::forward<T>(value));
+      return;
+    }
+
+    XSprePUSH;
+    if (policy == return_policy::count)
+    {
+      dXSTARG;
+      PUSHu(static_cast<UV>(list_size(value)));
+      ++m_pushed;
+    }
+    else
+    {
+      push_list_ref(value);
+    }
+  }
+
+  template <typename T, std::enable_if_t<!is_tuple<T>::value, bool> = true>
+  static std::size_t list_size(const T& value) { return value.size(); }
+
+  template <typename T, std::enable_if_t<is_tuple<T>::value, bool> = true>
+  static std::size_t list_size(const T& value) { return std::tuple_size<T>::value; }
+
+  template <typename T>
+  void push_list_ref(const T& value) { push_ref(value); }
+  void push_list_ref(const array& value) { push(reference(value)); }
+  void push_list_ref(const hash& value) { push(reference(value)); }
+
+  template <typename T>
+  void push_return_impl(T&& value, target_return)
+  {
+    dXSTARG;
+    push_target(targ, std::forward<T>(value));
+    ++m_pushed;
+  }
+
+  template <typename T, std::enable_if_t<detail::is_signed_integral_or_enum<T>::value, bool> = true>
+  void push_target(SV* targ, T value) { PUSHi(static_cast<IV>(value)); }
+
+  template <typename T, std::enable_if_t<std::is_unsigned<T>::value, bool> = true>
+  void push_target(SV* targ, T value) { PUSHu(static_cast<UV>(value)); }
+
+  template <typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+  void push_target(SV* targ, T value) { PUSHn(static_cast<NV>(value)); }
+
+  void push_target(SV* targ, const std::string& value) { PUSHp(value.c_str(), value.size()); }
+#ifdef __cpp_lib_string_view
+  void push_target(SV* targ, std::string_view value) { PUSHp(value.data(), value.size()); }
+#endif
+
+  void push_target(SV* targ, const char* value)
+  {
+    if (value)
+      PUSHp(value, strlen(value));
+    else
+      PUSHs(&PL_sv_undef);
+  }
+
   int ax = 0;
   int items = 0;
   SV** mark = nullptr;
   const char* m_pkg_name = nullptr;
   const char* m_sub_name = nullptr;
+  U8 m_gimme = 0;
+
+  // calling context, only looked up once per call
+  U8 gimme()
+  {
+    if (!m_gimme)
+      m_gimme = GIMME_V;
+    return m_gimme;
+  }
 
   std::string get_type_name(SV* item)
   {
@@ -104,32 +265,29 @@ protected:
 
 private:
   template <typename T>
-  bool check_index(T t, size_t index)
+  bool read_index(stack::staged<T>& value, int index, bool strict)
   {
-    return stack::read_as<T>::check(my_perl, static_cast<int>(index), ax, items);
-  }
-
-  // return true if perl stack matches all expected argument types in tuple
-  template <typename Tuple, size_t... I>
-  bool check_stack(Tuple&& t, std::index_sequence<I...>)
-  {
-    // lists compatibility of each expected arg type (no short-circuit)
-    std::initializer_list<bool> res = {
-      check_index(std::get<I>(std::forward<Tuple>(t)), I)... };
-
-    return std::all_of(res.begin(), res.end(), [](bool same) { return same; });
-  }
+    if (stack::try_read(my_perl, index, ax, items, value))
+      return true;
 
-  template <typename T>
-  T get_stack_index(T t, size_t index)
-  {
-    return stack::read_as<T>::get(my_perl, static_cast<int>(index), ax, items);
+    if (strict)
+    {
+      stack::read_as<T>::get(my_perl, index, ax, items); // throws reader's error
+      throw std::runtime_error("expected argument " + std::to_string(index+1) + " to be compatible with '" + util::type_name<T>::str() + "'");
+    }
+    return false;
   }
 
   template <typename Tuple, size_t... I>
-  auto get_stack(Tuple&& t, std::index_sequence<I...>)
+  bool read_stack(Tuple& args, bool strict, std::index_sequence<I...>)
   {
-    return Tuple{ get_stack_index(std::get<I>(std::forward<Tuple>(t)), I)... };
+    // reads in order and stops at the first incompatible argument
+    (void)strict; // unused for functions without parameters
+    bool result = true;
+    (void)std::initializer_list<int>{
+      (result = result && read_index(std::get<I>(args), static_cast<int>(I), strict), 0)... };
+
+    return result;
   }
 };
 
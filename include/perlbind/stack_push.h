@@ -1,6 +1,13 @@
 #pragma once
 
+#include <array>
+#include <map>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace perlbind { namespace stack {
 
@@ -28,7 +35,13 @@ struct pusher
     ++m_pushed;
   }
   void push(const std::string& value) { mPUSHp(value.c_str(), value.size()); ++m_pushed; }
+#ifdef __cpp_lib_string_view
+  void push(std::string_view value) { mPUSHp(value.data(), value.size()); ++m_pushed; }
+#endif
   void push(scalar value) { mPUSHs(value.release()); ++m_pushed; }
+  void push(const scalar_ref& value) { PUSHs(sv_mortalcopy(value.sv())); ++m_pushed; }
+  void push(const array_ref& value) { mPUSHs(newRV_inc(value.sv())); ++m_pushed; }
+  void push(const hash_ref& value) { mPUSHs(newRV_inc(value.sv())); ++m_pushed; }
   void push(reference value) { mPUSHs(value.release()); ++m_pushed; }
 
   void push(array value)
@@ -71,18 +84,84 @@ struct pusher
   template <typename T, std::enable_if_t<std::is_pointer<T>::value, bool> = true>
   void push(T value)
   {
-    const char* type_name = detail::typemap::get_name<T>(my_perl);
-    if (!type_name)
+    SV* sv = sv_newmortal();
+    if (!detail::typemap::set_object<T>(my_perl, sv, value))
     {
       throw std::runtime_error("cannot push unregistered pointer of type '" + util::type_name<T>::str() + "'");
     }
 
-    SV* sv = sv_newmortal();
-    sv_setref_pv(sv, type_name, static_cast<void*>(value));
     PUSHs(sv);
     ++m_pushed;
   };
 
+  // objects of registered classes returned by value are stored in the perl object
+  template <typename T, std::enable_if_t<detail::is_value_object<std::decay_t<T>>::value, bool> = true>
+  void push(T&& value)
+  {
+    SV* sv = sv_newmortal();
+    if (!detail::typemap::set_value(my_perl, sv, std::forward<T>(value)))
+    {
+      throw std::runtime_error("cannot push unregistered object of type '" + util::type_name<std::decay_t<T>>::str() + "'");
+    }
+
+    PUSHs(sv);
+    ++m_pushed;
+  }
+
+  // objects held by smart pointers are owned by perl until perl frees them
+  template <typename T>
+  void push(std::shared_ptr<T> value)
+  {
+    if (!value)
+    {
+      PUSHs(&PL_sv_undef);
+      ++m_pushed;
+      return;
+    }
+
+    SV* sv = sv_newmortal();
+    using object_t = std::remove_cv_t<T>;
+    auto owner = std::const_pointer_cast<object_t>(std::move(value));
+    object_t* ptr = owner.get();
+    if (!detail::typemap::set_object<object_t*>(my_perl, sv, ptr, std::move(owner)))
+    {
+      throw std::runtime_error("cannot push unregistered pointer of type '" + util::type_name<object_t*>::str() + "'");
+    }
+
+    PUSHs(sv);
+    ++m_pushed;
+  }
+
+  template <typename T, typename D>
+  void push(std::unique_ptr<T, D> value)
+  {
+    push(std::shared_ptr<T>(std::move(value)));
+  }
+
+  // native containers are pushed as a flattened list (maps as key value pairs)
+  // use as_ref<T> to push a reference instead. nested containers are references
+  template <typename T, typename A>
+  void push(const std::vector<T, A>& value) { push_list(value); }
+
+  template <typename T, std::size_t N>
+  void push(const std::array<T, N>& value) { push_list(value); }
+
+  template <typename K, typename V, typename C, typename A>
+  void push(const std::map<K, V, C, A>& value) { push_map(value); }
+
+  template <typename K, typename V, typename H, typename E, typename A>
+  void push(const std::unordered_map<K, V, H, E, A>& value) { push_map(value); }
+
+  // pairs and tuples are pushed as a list of their elements
+  template <typename T1, typename T2>
+  void push(const std::pair<T1, T2>& value) { push_list(value); }
+
+  template <typename... Args>
+  void push(const std::tuple<Args...>& value) { push_list(value); }
+
+  template <typename T>
+  void push(const as_ref<T>& value) { push_ref(value.value); }
+
   void push(void* value)
   {
     SV* sv = sv_newmortal();
@@ -94,7 +173,7 @@ struct pusher
   template <typename... Args>
   void push_args(Args&&... args)
   {
-    EXTEND(sp, sizeof...(Args));
+    EXTEND(sp, static_cast<SSize_t>(sizeof...(Args)));
     push_args_impl(std::forward<Args>(args)...);
   };
 
@@ -103,10 +182,126 @@ protected:
   SV** sp = nullptr;
   int m_pushed = 0;
 
+  // elements of containers, nested containers are pushed as references
+  template <typename T, std::enable_if_t<detail::is_container<T>::value, bool> = true>
+  void push_element(const T& value) { push_ref(value); }
+
+  template <typename T, std::enable_if_t<!detail::is_container<T>::value, bool> = true>
+  void push_element(const T& value) { push(value); }
+
+  template <typename T>
+  void push_list(const T& value)
+  {
+    EXTEND(sp, static_cast<SSize_t>(value.size()));
+    for (const auto& item : value)
+      push_element(item);
+  }
+
+  template <typename T1, typename T2>
+  void push_list(const std::pair<T1, T2>& value)
+  {
+    EXTEND(sp, 2);
+    push_element(value.first);
+    push_element(value.second);
+  }
+
+  template <typename... Args>
+  void push_list(const std::tuple<Args...>& value)
+  {
+    EXTEND(sp, static_cast<SSize_t>(sizeof...(Args)));
+    push_tuple(value, std::index_sequence_for<Args...>());
+  }
+
+  template <typename Tuple, std::size_t... I>
+  void push_tuple(const Tuple& value, std::index_sequence<I...>)
+  {
+    (void)std::initializer_list<int>{ (push_element(std::get<I>(value)), 0)... };
+  }
+
+  template <typename T>
+  void push_map(const T& value)
+  {
+    EXTEND(sp, static_cast<SSize_t>(value.size() * 2));
+    for (const auto& item : value)
+    {
+      push(item.first);
+      push_element(item.second);
+    }
+  }
+
+  // pushes elements then moves them from the stack into a presized array
+  template <typename T, std::enable_if_t<detail::is_list_container<T>::value, bool> = true>
+  void push_ref(const T& value)
+  {
+    int pushed = m_pushed;
+    push_list(value);
+    int count = m_pushed - pushed;
+
+    AV* av = newAV();
+    if (count > 0)
+    {
+      av_extend(av, count - 1);
+      SV** items = AvARRAY(av);
+      for (int i = count - 1; i >= 0; --i) // last pushed mortal is on top of tmps
+        items[i] = take_pushed(*sp--);
+
+      AvFILLp(av) = count - 1;
+    }
+
+    m_pushed = pushed;
+    mPUSHs(newRV_noinc(reinterpret_cast<SV*>(av)));
+    ++m_pushed;
+  }
+
+  template <typename T, std::enable_if_t<detail::is_map_container<T>::value, bool> = true>
+  void push_ref(const T& value)
+  {
+    HV* hv = newHV();
+    hv_ksplit(hv, static_cast<IV>(value.size()));
+    for (const auto& item : value)
+    {
+      push_element(item.second);
+      SV* val = take_pushed(*sp--);
+      --m_pushed;
+      if (!hash_store(hv, item.first, val))
+        SvREFCNT_dec(val);
+    }
+
+    mPUSHs(newRV_noinc(reinterpret_cast<SV*>(hv)));
+    ++m_pushed;
+  }
+
 private:
   template <typename... Args>
   void push_args_impl(Args&&... args) {}
 
+  bool hash_store(HV* hv, const std::string& key, SV* val)
+  {
+    return hv_store(hv, key.c_str(), static_cast<I32>(key.size()), val, 0) != nullptr;
+  }
+
+  template <typename K>
+  bool hash_store(HV* hv, const K& key, SV* val)
+  {
+    push(key); // mortal key formatted like perl stringifies it
+    SV* keysv = *sp--;
+    --m_pushed;
+    return hv_store_ent(hv, keysv, val, 0) != nullptr;
+  }
+
+  // returns a pushed value owned by the caller. a new mortal still on top of
+  // the temps stack is taken from it instead of being copied
+  SV* take_pushed(SV* sv)
+  {
+    if (SvTEMP(sv) && SvREFCNT(sv) == 1 && PL_tmps_ix > PL_tmps_floor && PL_tmps_stack[PL_tmps_ix] == sv)
+    {
+      --PL_tmps_ix;
+      SvTEMP_off(sv);
+      return sv;
+    }
+    return newSVsv(sv);
+  }
+
   template <typename T, typename... Args>
   void push_args_impl(T&& value, Args&&... args)
   {
@@ -1,16 +1,114 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace perlbind { namespace stack {
 
+// kind flags of a perl stack value, used by overload dispatch to reject
+// incompatible functions without calling each reader's check()
+namespace kind
+{
+  constexpr std::uint8_t any        = 1 << 0; // set for every value
+  constexpr std::uint8_t scalar     = 1 << 1; // SvTYPE < SVt_PVAV
+  constexpr std::uint8_t integer    = 1 << 2; // SvIOK
+  constexpr std::uint8_t number     = 1 << 3; // SvNOK
+  constexpr std::uint8_t string     = 1 << 4; // SvPOK
+  constexpr std::uint8_t ref        = 1 << 5; // SvROK
+  constexpr std::uint8_t scalar_ref = 1 << 6; // reference to a non-aggregate
+  constexpr std::uint8_t object     = 1 << 7; // reference to a blessed value
+} // namespace kind
+
+// returns kind flags of a stack value (get magic is not called)
+inline std::uint8_t classify(SV* sv)
+{
+  std::uint8_t flags = kind::any;
+  if (SvTYPE(sv) < SVt_PVAV) flags |= kind::scalar;
+  if (SvIOK(sv))             flags |= kind::integer;
+  if (SvNOK(sv))             flags |= kind::number;
+  if (SvPOK(sv))             flags |= kind::string;
+  if (SvROK(sv))
+  {
+    flags |= kind::ref;
+    if (SvTYPE(SvRV(sv)) < SVt_PVAV) flags |= kind::scalar_ref;
+    if (SvOBJECT(SvRV(sv)))          flags |= kind::object;
+  }
+  return flags;
+}
+
+// storage for a converted stack argument, only constructed by a successful read
+template <typename T>
+class staged
+{
+public:
+  staged() = default;
+  staged(const staged&) = delete;
+  staged& operator=(const staged&) = delete;
+  ~staged() { reset(); }
+
+  template <typename... Args>
+  void emplace(Args&&... args)
+  {
+    reset();
+    new (&m_storage) T(std::forward<Args>(args)...);
+    m_valid = true;
+  }
+
+  void reset()
+  {
+    if (m_valid)
+      value().~T();
+    m_valid = false;
+  }
+
+  bool has_value() const { return m_valid; }
+  T& value() { return *reinterpret_cast<T*>(&m_storage); }
+
+private:
+  typename std::aligned_storage<sizeof(T), alignof(T)>::type m_storage;
+  bool m_valid = false;
+};
+
+// object references are staged as reference wrappers that convert to the
+// reference when moved into the call. const references to other types are
+// staged as values of the type
+template <typename T>
+using staged_ref_t = std::conditional_t<std::is_const<T>::value && !detail::is_object_class<std::remove_cv_t<T>>::value,
+                                        std::remove_cv_t<T>, std::reference_wrapper<T>>;
+
+template <typename T>
+class staged<T&> : public staged<staged_ref_t<T>> {};
+
 // perl stack reader to convert types, throws if perl stack value isn't type compatible
-template <typename T, typename = void>
-struct read_as;
+// readers may declare a 'mask' of kind flags a value needs one of to pass check()
+// and set 'exact' if matching the mask is sufficient for check() to pass
+// readers may implement 'try_get' to check and convert a value in a single pass
+template <typename T, typename>
+struct read_as; // default argument in forward.h
 
 template <typename T>
 struct read_as<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>>
 {
+#ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
+  static constexpr std::uint8_t mask = kind::scalar;
+#elif !defined PERLBIND_STRICT_NUMERIC_TYPES
+  static constexpr std::uint8_t mask = kind::integer | kind::number;
+#else
+  static constexpr std::uint8_t mask = kind::integer;
+#endif
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
 #ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
@@ -30,11 +128,29 @@ struct read_as<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>
     }
     return static_cast<T>(SvIV(ST(i))); // unsigned and bools casted
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(static_cast<T>(SvIV(ST(i))));
+    return true;
+  }
 };
 
 template <typename T>
 struct read_as<T, std::enable_if_t<std::is_floating_point<T>::value>>
 {
+#ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
+  static constexpr std::uint8_t mask = kind::scalar;
+#elif !defined PERLBIND_STRICT_NUMERIC_TYPES
+  static constexpr std::uint8_t mask = kind::integer | kind::number;
+#else
+  static constexpr std::uint8_t mask = kind::number;
+#endif
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
 #ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
@@ -54,11 +170,27 @@ struct read_as<T, std::enable_if_t<std::is_floating_point<T>::value>>
     }
     return static_cast<T>(SvNV(ST(i)));
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(static_cast<T>(SvNV(ST(i))));
+    return true;
+  }
 };
 
 template <>
 struct read_as<const char*>
 {
+#ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
+  static constexpr std::uint8_t mask = kind::scalar;
+#else
+  static constexpr std::uint8_t mask = kind::string;
+#endif
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
 #ifdef PERLBIND_NO_STRICT_SCALAR_TYPES
@@ -76,16 +208,74 @@ struct read_as<const char*>
     }
     return static_cast<const char*>(SvPV_nolen(ST(i)));
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<const char*>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(SvPV_nolen(ST(i)));
+    return true;
+  }
 };
 
+// strings are read with their perl length (may contain embedded nulls)
 template <>
 struct read_as<std::string> : read_as<const char*>
 {
+  static std::string get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    read_as<const char*>::get(my_perl, i, ax, items); // throws if incompatible
+    STRLEN len = 0;
+    const char* str = SvPV(ST(i), len);
+    return std::string(str, len);
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<std::string>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    STRLEN len = 0;
+    const char* str = SvPV(ST(i), len);
+    value.emplace(str, len);
+    return true;
+  }
 };
 
+#ifdef __cpp_lib_string_view
+// views the perl string buffer of an argument without copying, only valid
+// for the duration of the call
+template <>
+struct read_as<std::string_view> : read_as<const char*>
+{
+  static std::string_view get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    read_as<const char*>::get(my_perl, i, ax, items); // throws if incompatible
+    STRLEN len = 0;
+    const char* str = SvPV(ST(i), len);
+    return std::string_view(str, len);
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<std::string_view>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    STRLEN len = 0;
+    const char* str = SvPV(ST(i), len);
+    value.emplace(str, len);
+    return true;
+  }
+};
+#endif
+
 template <>
 struct read_as<void*>
 {
+  static constexpr std::uint8_t mask = kind::object;
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
     return sv_isobject(ST(i));
@@ -101,20 +291,32 @@ struct read_as<void*>
     IV tmp = SvIV(SvRV(ST(i)));
     return INT2PTR(void*, tmp);
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<void*>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(INT2PTR(void*, SvIV(SvRV(ST(i)))));
+    return true;
+  }
 };
 
 template <typename T>
 struct read_as<T, std::enable_if_t<std::is_pointer<T>::value>>
 {
+  static constexpr std::uint8_t mask = kind::object; // still requires derived type check
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
-    const char* type_name = detail::typemap::get_name<T>(my_perl);
-    return type_name && sv_isobject(ST(i)) && sv_derived_from(ST(i), type_name);
+    T value;
+    return detail::typemap::get_object<T>(my_perl, ST(i), value);
   }
 
   static T get(PerlInterpreter* my_perl, int i, int ax, int items)
   {
-    if (!check(my_perl, i, ax, items))
+    T value;
+    if (!detail::typemap::get_object<T>(my_perl, ST(i), value))
     {
       // would prefer to check for unregistered types at compile time (not possible?)
       const char* type_name = detail::typemap::get_name<T>(my_perl);
@@ -125,37 +327,153 @@ struct read_as<T, std::enable_if_t<std::is_pointer<T>::value>>
       throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a reference to an object of type '" + type_name + "'");
     }
 
-    IV tmp = SvIV(SvRV(ST(i)));
-    return INT2PTR(T, tmp);
+    return value;
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value)
+  {
+    T ptr;
+    if (!detail::typemap::get_object<T>(my_perl, ST(i), ptr))
+      return false;
+
+    value.emplace(ptr);
+    return true;
   }
 };
 
+// reference to an object of a registered class, rejects objects with a null pointer
 template <typename T>
-struct read_as<nullable<T>>
+struct read_as<T&, std::enable_if_t<detail::is_object_class<std::remove_cv_t<T>>::value>>
 {
+  using object_t = std::remove_cv_t<T>;
+  static constexpr std::uint8_t mask = kind::object;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
+    object_t* value = nullptr;
+    return detail::typemap::get_object<object_t*>(my_perl, ST(i), value) && value;
+  }
+
+  static T& get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    object_t* value = nullptr;
+    if (!detail::typemap::get_object<object_t*>(my_perl, ST(i), value) || !value)
+    {
+      read_as<object_t*>::get(my_perl, i, ax, items); // throws type error
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a reference to a valid object");
+    }
+    return *value;
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<T&>& value)
+  {
+    object_t* ptr = nullptr;
+    if (!detail::typemap::get_object<object_t*>(my_perl, ST(i), ptr) || !ptr)
+      return false;
+
+    value.emplace(*ptr);
     return true;
   }
+};
 
-  static nullable<T> get(PerlInterpreter* my_perl, int i, int ax, int items)
+// const references to other types are read by value (e.g. const std::string&)
+template <typename T>
+struct read_as<const T&, std::enable_if_t<!detail::is_object_class<T>::value>> : read_as<T> {};
+
+// copy of an object of a registered class that opted in with by_value<T>
+template <typename T>
+struct read_as<T, std::enable_if_t<detail::is_value_object<T>::value>>
+{
+  static constexpr std::uint8_t mask = kind::object;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return read_as<T&>::check(my_perl, i, ax, items);
+  }
+
+  static T get(PerlInterpreter* my_perl, int i, int ax, int items)
   {
-    if (sv_isobject(ST(i)))
+    return read_as<T&>::get(my_perl, i, ax, items);
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value)
+  {
+    T* ptr = nullptr;
+    if (!detail::typemap::get_object<T*>(my_perl, ST(i), ptr) || !ptr)
+      return false;
+
+    value.emplace(*ptr);
+    return true;
+  }
+};
+
+// shares ownership of an object held by perl as a smart pointer
+template <typename T>
+struct read_as<std::shared_ptr<T>>
+{
+  using object_t = std::remove_cv_t<T>;
+  static constexpr std::uint8_t mask = kind::object;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    staged<std::shared_ptr<T>> value;
+    return try_get(my_perl, i, ax, items, value);
+  }
+
+  static std::shared_ptr<T> get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    staged<std::shared_ptr<T>> value;
+    if (!try_get(my_perl, i, ax, items, value))
     {
-      const char* type_name = detail::typemap::get_name<T>(my_perl);
-      if (type_name && sv_derived_from(ST(i), type_name))
-      {
-        IV tmp = SvIV(SvRV(ST(i)));
-        return INT2PTR(T, tmp);
-      }
+      read_as<object_t*>::get(my_perl, i, ax, items); // throws type error
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a reference to an object owned by perl");
     }
-    return nullptr;
+    return std::move(value.value());
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<std::shared_ptr<T>>& value)
+  {
+    object_t* ptr = nullptr;
+    const std::shared_ptr<void>* owner = nullptr;
+    if (!detail::typemap::get_object<object_t*>(my_perl, ST(i), ptr, &owner) || !owner)
+      return false;
+
+    value.emplace(*owner, ptr); // aliases the owner, the object isn't copied
+    return true;
+  }
+};
+
+template <typename T>
+struct read_as<nullable<T>>
+{
+  static constexpr std::uint8_t mask = kind::any;
+  static constexpr bool exact = true;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return true;
+  }
+
+  static nullable<T> get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    T value = nullptr;
+    detail::typemap::get_object<T>(my_perl, ST(i), value);
+    return value;
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<nullable<T>>& value)
+  {
+    value.emplace(get(my_perl, i, ax, items));
+    return true;
   }
 };
 
 template <>
 struct read_as<SV*>
 {
+  static constexpr std::uint8_t mask = kind::any;
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
     return i < items;
@@ -169,12 +487,24 @@ struct read_as<SV*>
     }
     return ST(i);
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<SV*>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(ST(i));
+    return true;
+  }
 };
 
 // scalar, array, and hash readers return reference to stack items (not copies)
 template <>
 struct read_as<scalar>
 {
+  static constexpr std::uint8_t mask = kind::scalar | kind::scalar_ref;
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
     return (SvROK(ST(i)) && SvTYPE(SvRV(ST(i))) < SVt_PVAV) || SvTYPE(ST(i)) < SVt_PVAV;
@@ -188,11 +518,23 @@ struct read_as<scalar>
     }
     return SvROK(ST(i)) ? SvREFCNT_inc(SvRV(ST(i))) : SvREFCNT_inc(ST(i));
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<scalar>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(SvROK(ST(i)) ? SvREFCNT_inc(SvRV(ST(i))) : SvREFCNT_inc(ST(i)));
+    return true;
+  }
 };
 
 template <>
 struct read_as<reference>
 {
+  static constexpr std::uint8_t mask = kind::ref;
+  static constexpr bool exact = true;
+
   static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
   {
     return SvROK(ST(i));
@@ -209,6 +551,105 @@ struct read_as<reference>
     result.reset(SvREFCNT_inc(ST(i)));
     return result;
   }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<reference>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace();
+    value.value().reset(SvREFCNT_inc(ST(i)));
+    return true;
+  }
+};
+
+// borrowed readers view stack items without taking a reference
+template <>
+struct read_as<scalar_ref>
+{
+  static constexpr std::uint8_t mask = kind::scalar | kind::scalar_ref;
+  static constexpr bool exact = true;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return read_as<scalar>::check(my_perl, i, ax, items);
+  }
+
+  static scalar_ref get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a scalar or reference to a scalar");
+    }
+    return scalar_ref(my_perl, SvROK(ST(i)) ? SvRV(ST(i)) : ST(i));
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<scalar_ref>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(my_perl, SvROK(ST(i)) ? SvRV(ST(i)) : ST(i));
+    return true;
+  }
+};
+
+template <>
+struct read_as<array_ref>
+{
+  static constexpr std::uint8_t mask = kind::ref;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return SvROK(ST(i)) && SvTYPE(SvRV(ST(i))) == SVt_PVAV;
+  }
+
+  static array_ref get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be an array reference");
+    }
+    return array_ref(my_perl, reinterpret_cast<AV*>(SvRV(ST(i))));
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<array_ref>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(my_perl, reinterpret_cast<AV*>(SvRV(ST(i))));
+    return true;
+  }
+};
+
+template <>
+struct read_as<hash_ref>
+{
+  static constexpr std::uint8_t mask = kind::ref;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return SvROK(ST(i)) && SvTYPE(SvRV(ST(i))) == SVt_PVHV;
+  }
+
+  static hash_ref get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a hash reference");
+    }
+    return hash_ref(my_perl, reinterpret_cast<HV*>(SvRV(ST(i))));
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<hash_ref>& value)
+  {
+    if (!check(my_perl, i, ax, items))
+      return false;
+
+    value.emplace(my_perl, reinterpret_cast<HV*>(SvRV(ST(i))));
+    return true;
+  }
 };
 
 template <>
@@ -255,12 +696,582 @@ struct read_as<hash>
     hash result;
     for (int index = i; index < items; index += 2)
     {
-      const char* key = SvPV_nolen(ST(index));
-      result[key] = SvREFCNT_inc(ST(index + 1));
+      STRLEN len = 0;
+      const char* key = SvPV(ST(index), len);
+      result[std::string(key, len)] = SvREFCNT_inc(ST(index + 1));
+    }
+    return result;
+  }
+};
+
+// variadic views read the rest of the stack without copying it (may be empty)
+template <>
+struct read_as<args>
+{
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return items >= i;
+  }
+
+  static args get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be start of variadic arguments");
     }
+    return args(my_perl, ax, i, items);
+  }
+};
+
+template <>
+struct read_as<kwargs>
+{
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    int remaining = items - i;
+    return remaining >= 0 && remaining % 2 == 0;
+  }
+
+  static kwargs get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be start of key value pairs");
+    }
+    return kwargs(my_perl, ax, i, items);
+  }
+};
+
+// converts stack item i into value if compatible, returns false otherwise
+// readers without a try_get are adapted by calling check() then get()
+template <typename T>
+auto try_read(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value, int)
+  -> decltype(read_as<T>::try_get(my_perl, i, ax, items, value))
+{
+  return read_as<T>::try_get(my_perl, i, ax, items, value);
+}
+
+template <typename T>
+bool try_read(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value, long)
+{
+  if (!read_as<T>::check(my_perl, i, ax, items))
+    return false;
+
+  value.emplace(read_as<T>::get(my_perl, i, ax, items));
+  return true;
+}
+
+template <typename T>
+bool try_read(PerlInterpreter* my_perl, int i, int ax, int items, staged<T>& value)
+{
+  return try_read(my_perl, i, ax, items, value, 0);
+}
+
+// converts values of perl arrays and hashes with the stack reader of their
+// native type. each value is placed in a slot reserved above the top of the
+// stack so readers see it as a stack item (the slot index stays valid if a
+// nested call from a reader grows the stack)
+class element_slot
+{
+public:
+  explicit element_slot(PerlInterpreter* interp) : my_perl(interp)
+  {
+    SV** sp = PL_stack_sp;
+    EXTEND(sp, 1);
+    *++sp = &PL_sv_undef;
+    PL_stack_sp = sp;
+    m_ax = static_cast<int>(sp - PL_stack_base);
+  }
+  element_slot(const element_slot&) = delete;
+  element_slot& operator=(const element_slot&) = delete;
+  ~element_slot() { PL_stack_sp = PL_stack_base + m_ax - 1; }
+
+  template <typename T>
+  bool read(SV* sv, staged<T>& value)
+  {
+    PL_stack_base[m_ax] = sv;
+    return try_read(my_perl, 0, m_ax, 1, value);
+  }
+
+private:
+  PerlInterpreter* my_perl = nullptr;
+  int m_ax = 0;
+};
+
+// returns array of an array reference or nullptr
+inline AV* get_array_ref(SV* sv)
+{
+  return SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVAV ? reinterpret_cast<AV*>(SvRV(sv)) : nullptr;
+}
+
+inline HV* get_hash_ref(SV* sv)
+{
+  return SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVHV ? reinterpret_cast<HV*>(SvRV(sv)) : nullptr;
+}
+
+// calls func(index, element) for each array element until it returns false
+// elements are read from AvARRAY unless the array has magic (e.g. tied)
+template <typename F>
+bool for_each_element(PerlInterpreter* my_perl, AV* av, F&& func)
+{
+  SSize_t count = av_top_index(av) + 1;
+  if (!SvRMAGICAL(av))
+  {
+    SV** items = AvARRAY(av);
+    for (SSize_t i = 0; i < count; ++i)
+    {
+      if (!func(i, items[i] ? items[i] : &PL_sv_undef))
+        return false;
+    }
+    return true;
+  }
+
+  for (SSize_t i = 0; i < count; ++i)
+  {
+    SV** svp = av_fetch(av, i, 0);
+    SV* sv = svp ? *svp : &PL_sv_undef;
+    SvGETMAGIC(sv);
+    if (!func(i, sv))
+      return false;
+  }
+  return true;
+}
+
+// calls func(entry, value) for each hash entry until it returns false
+// entries are read from the bucket array unless the hash has magic (e.g. tied)
+// so a script's each/keys iterator over the hash isn't reset
+template <typename F>
+bool for_each_entry(PerlInterpreter* my_perl, HV* hv, F&& func)
+{
+  if (!SvRMAGICAL(hv))
+  {
+    STRLEN bucket = 0;
+    for (HE* he = detail::next_hash_entry(my_perl, hv, nullptr, bucket); he; he = detail::next_hash_entry(my_perl, hv, he, bucket))
+    {
+      if (!func(he, HeVAL(he)))
+        return false;
+    }
+    return true;
+  }
+
+  hv_iterinit(hv);
+  while (HE* he = hv_iternext(hv))
+  {
+    if (!func(he, hv_iterval(hv, he)))
+      return false;
+  }
+  return true;
+}
+
+// reads a native container with try_get(), get() throws if it isn't compatible
+template <typename T>
+struct container_reader
+{
+  static constexpr std::uint8_t mask = kind::ref;
+
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    staged<T> value;
+    return read_as<T>::try_get(my_perl, i, ax, items, value);
+  }
+
+  static T get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    staged<T> value;
+    if (!read_as<T>::try_get(my_perl, i, ax, items, value))
+    {
+      throw std::runtime_error("expected argument " + std::to_string(i+1) + " to be a reference compatible with '" + util::type_name<T>::str() + "'");
+    }
+    return std::move(value.value());
+  }
+};
+
+// std::vector from an array reference, elements are converted by their readers
+template <typename T, typename A>
+struct read_as<std::vector<T, A>> : container_reader<std::vector<T, A>>
+{
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<std::vector<T, A>>& value)
+  {
+    AV* av = get_array_ref(ST(i));
+    if (!av)
+      return false;
+
+    value.emplace();
+    auto& result = value.value();
+    result.reserve(static_cast<std::size_t>(av_top_index(av) + 1));
+
+    element_slot slot(my_perl);
+    staged<T> elem;
+    return for_each_element(my_perl, av, [&](SSize_t, SV* sv) {
+      if (!slot.read(sv, elem))
+        return false;
+
+      result.push_back(std::move(elem.value()));
+      return true;
+    });
+  }
+};
+
+// std::array from an array reference with exactly N elements
+template <typename T, std::size_t N>
+struct read_as<std::array<T, N>> : container_reader<std::array<T, N>>
+{
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<std::array<T, N>>& value)
+  {
+    AV* av = get_array_ref(ST(i));
+    if (!av || av_top_index(av) + 1 != static_cast<SSize_t>(N))
+      return false;
+
+    value.emplace();
+    auto& result = value.value();
+
+    element_slot slot(my_perl);
+    staged<T> elem;
+    return for_each_element(my_perl, av, [&](SSize_t index, SV* sv) {
+      if (!slot.read(sv, elem))
+        return false;
+
+      result[index] = std::move(elem.value());
+      return true;
+    });
+  }
+};
+
+// std::tuple and std::pair from an array reference with an element per member
+template <typename Tuple>
+struct tuple_reader : container_reader<Tuple>
+{
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<Tuple>& value)
+  {
+    using make_sequence = std::make_index_sequence<std::tuple_size<Tuple>::value>;
+    return read_tuple(my_perl, ST(i), value, make_sequence());
+  }
+
+private:
+  template <std::size_t... I>
+  static bool read_tuple(PerlInterpreter* my_perl, SV* ref, staged<Tuple>& value, std::index_sequence<I...>)
+  {
+    AV* av = get_array_ref(ref);
+    if (!av || av_top_index(av) + 1 != static_cast<SSize_t>(sizeof...(I)))
+      return false;
+
+    element_slot slot(my_perl);
+    std::tuple<staged<std::tuple_element_t<I, Tuple>>...> elems;
+    bool result = true;
+    (void)std::initializer_list<int>{
+      (result = result && read_element(my_perl, av, static_cast<SSize_t>(I), slot, std::get<I>(elems)), 0)... };
+
+    if (result)
+      value.emplace(std::move(std::get<I>(elems).value())...);
+
     return result;
   }
+
+  template <typename T>
+  static bool read_element(PerlInterpreter* my_perl, AV* av, SSize_t index, element_slot& slot, staged<T>& value)
+  {
+    SV** svp = av_fetch(av, index, 0);
+    SV* sv = svp ? *svp : &PL_sv_undef;
+    SvGETMAGIC(sv);
+    return slot.read(sv, value);
+  }
 };
 
+template <typename T1, typename T2>
+struct read_as<std::pair<T1, T2>> : tuple_reader<std::pair<T1, T2>> {};
+
+template <typename... Args>
+struct read_as<std::tuple<Args...>> : tuple_reader<std::tuple<Args...>> {};
+
+// converts hash keys to native map keys, numeric keys must be numeric strings
+template <typename K, typename = void>
+struct hash_key;
+
+template <>
+struct hash_key<std::string>
+{
+  static bool get(PerlInterpreter* my_perl, const char* key, STRLEN len, std::string& value)
+  {
+    value.assign(key, len);
+    return true;
+  }
+};
+
+template <typename K>
+struct hash_key<K, std::enable_if_t<std::is_integral<K>::value || std::is_enum<K>::value>>
+{
+  static bool get(PerlInterpreter* my_perl, const char* key, STRLEN len, K& value)
+  {
+    UV uv = 0;
+    int flags = grok_number(key, len, &uv);
+    if (!(flags & IS_NUMBER_IN_UV) || (flags & IS_NUMBER_NOT_INT))
+      return false;
+
+    value = static_cast<K>((flags & IS_NUMBER_NEG) ? -static_cast<IV>(uv) : static_cast<IV>(uv));
+    return true;
+  }
+};
+
+template <typename K>
+struct hash_key<K, std::enable_if_t<std::is_floating_point<K>::value>>
+{
+  static bool get(PerlInterpreter* my_perl, const char* key, STRLEN len, K& value)
+  {
+    if (!grok_number(key, len, nullptr))
+      return false;
+
+    value = static_cast<K>(std::strtod(key, nullptr));
+    return true;
+  }
+};
+
+// std::map and std::unordered_map from a hash reference
+template <typename Map>
+struct map_reader : container_reader<Map>
+{
+  using key_type = typename Map::key_type;
+  using mapped_type = typename Map::mapped_type;
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<Map>& value)
+  {
+    HV* hv = get_hash_ref(ST(i));
+    if (!hv)
+      return false;
+
+    value.emplace();
+    auto& result = value.value();
+    reserve(result, HvUSEDKEYS(hv), 0);
+
+    element_slot slot(my_perl);
+    staged<mapped_type> elem;
+    key_type key{};
+    return for_each_entry(my_perl, hv, [&](HE* he, SV* val) {
+      STRLEN len = 0;
+      const char* pv = HePV(he, len);
+      if (!hash_key<key_type>::get(my_perl, pv, len, key) || !slot.read(val, elem))
+        return false;
+
+      result.emplace(std::move(key), std::move(elem.value()));
+      return true;
+    });
+  }
+
+private:
+  template <typename T>
+  static auto reserve(T& map, std::size_t count, int) -> decltype(map.reserve(count)) { map.reserve(count); }
+  template <typename T>
+  static void reserve(T& map, std::size_t count, long) {} // std::map
+};
+
+template <typename K, typename V, typename C, typename A>
+struct read_as<std::map<K, V, C, A>> : map_reader<std::map<K, V, C, A>> {};
+
+template <typename K, typename V, typename H, typename E, typename A>
+struct read_as<std::unordered_map<K, V, H, E, A>> : map_reader<std::unordered_map<K, V, H, E, A>> {};
+
+// converts value i returned by a perl sub with its stack reader, throws if it isn't compatible
+template <typename T>
+T read_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  staged<T> value;
+  if (!try_read(my_perl, i, ax, items, value))
+  {
+    throw std::runtime_error("expected return value " + std::to_string(i+1) + " to be compatible with '" + util::type_name<T>::str() + "'");
+  }
+  return std::move(value.value());
+}
+
+// converts value i returned by a perl sub. numbers and strings are converted
+// like perl does (e.g. undef, numeric strings and numbers as strings), other
+// types are read with their stack reader
+template <typename T, std::enable_if_t<std::is_same<T, bool>::value, bool> = true>
+T get_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  return SvTRUE(ST(i));
+}
+
+template <typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool> = true>
+T get_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  return static_cast<T>(SvIV(ST(i)));
+}
+
+template <typename T, std::enable_if_t<std::is_floating_point<T>::value, bool> = true>
+T get_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  return static_cast<T>(SvNV(ST(i)));
+}
+
+template <typename T, std::enable_if_t<std::is_same<T, std::string>::value, bool> = true>
+T get_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  STRLEN len = 0;
+  const char* str = SvPV(ST(i), len);
+  return std::string(str, len);
+}
+
+template <typename T, std::enable_if_t<!std::is_arithmetic<T>::value && !std::is_same<T, std::string>::value, bool> = true>
+T get_return(PerlInterpreter* my_perl, int i, int ax, int items)
+{
+  return read_return<T>(my_perl, i, ax, items);
+}
+
+// converts the value at ax returned by a perl sub called in scalar context
+template <typename T>
+T get_scalar_return(PerlInterpreter* my_perl, int ax)
+{
+  return get_return<T>(my_perl, 0, ax, 1);
+}
+
+// converts the values returned by a perl sub called in list context directly
+// from their stack slots. types without a list reader are returned in scalar context
+template <typename T, typename = void>
+struct read_list {};
+
+template <typename T, typename = void>
+struct has_list_reader : std::false_type {};
+
+template <typename T>
+struct has_list_reader<T, decltype(void(&read_list<T>::get))> : std::true_type {};
+
+inline void check_return_count(int items, std::size_t expected)
+{
+  if (items != static_cast<int>(expected))
+  {
+    throw std::runtime_error("expected " + std::to_string(expected) + " return value(s), got " + std::to_string(items));
+  }
+}
+
+template <typename T, typename A>
+struct read_list<std::vector<T, A>>
+{
+  static std::vector<T, A> get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    std::vector<T, A> result;
+    result.reserve(static_cast<std::size_t>(items));
+    for (int i = 0; i < items; ++i)
+      result.push_back(get_return<T>(my_perl, i, ax, items));
+
+    return result;
+  }
+};
+
+template <typename T, std::size_t N>
+struct read_list<std::array<T, N>>
+{
+  static std::array<T, N> get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    check_return_count(items, N);
+
+    std::array<T, N> result;
+    for (int i = 0; i < items; ++i)
+      result[i] = get_return<T>(my_perl, i, ax, items);
+
+    return result;
+  }
+};
+
+template <typename Tuple>
+struct tuple_list_reader
+{
+  static Tuple get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    check_return_count(items, std::tuple_size<Tuple>::value);
+    return get_impl(my_perl, ax, items, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+  }
+
+private:
+  template <std::size_t... I>
+  static Tuple get_impl(PerlInterpreter* my_perl, int ax, int items, std::index_sequence<I...>)
+  {
+    // braced initialization converts the values in order
+    return Tuple{ get_return<std::tuple_element_t<I, Tuple>>(my_perl, static_cast<int>(I), ax, items)... };
+  }
+};
+
+template <typename T1, typename T2>
+struct read_list<std::pair<T1, T2>> : tuple_list_reader<std::pair<T1, T2>> {};
+
+template <typename... Args>
+struct read_list<std::tuple<Args...>> : tuple_list_reader<std::tuple<Args...>> {};
+
+// maps are read from a list of key value pairs
+template <typename Map>
+struct map_list_reader
+{
+  using key_type = typename Map::key_type;
+  using mapped_type = typename Map::mapped_type;
+
+  static Map get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    if (items % 2 != 0)
+    {
+      throw std::runtime_error("expected key value pairs to be returned, got " + std::to_string(items) + " value(s)");
+    }
+
+    Map result;
+    key_type key{};
+    for (int i = 0; i < items; i += 2)
+    {
+      STRLEN len = 0;
+      const char* pv = SvPV(ST(i), len);
+      if (!hash_key<key_type>::get(my_perl, pv, len, key))
+      {
+        throw std::runtime_error("expected return value " + std::to_string(i+1) + " to be a key compatible with '" + util::type_name<key_type>::str() + "'");
+      }
+      result[std::move(key)] = get_return<mapped_type>(my_perl, i + 1, ax, items);
+    }
+    return result;
+  }
+};
+
+template <typename K, typename V, typename C, typename A>
+struct read_list<std::map<K, V, C, A>> : map_list_reader<std::map<K, V, C, A>> {};
+
+template <typename K, typename V, typename H, typename E, typename A>
+struct read_list<std::unordered_map<K, V, H, E, A>> : map_list_reader<std::unordered_map<K, V, H, E, A>> {};
+
+template <>
+struct read_list<array>
+{
+  static array get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    return items > 0 ? read_as<array>::get(my_perl, 0, ax, items) : array();
+  }
+};
+
+template <>
+struct read_list<hash>
+{
+  static hash get(PerlInterpreter* my_perl, int ax, int items)
+  {
+    return items > 0 ? read_as<hash>::get(my_perl, 0, ax, items) : hash();
+  }
+};
+
+template <typename Tuple>
+struct staged_tuple;
+
+template <typename... Args>
+struct staged_tuple<std::tuple<Args...>>
+{
+  using type = std::tuple<staged<Args>...>;
+};
+
+// kind mask of a reader, readers without one are only matched by check()
+template <typename T, typename = void>
+struct arg_mask : std::integral_constant<std::uint8_t, kind::any> {};
+
+template <typename T>
+struct arg_mask<T, decltype(void(read_as<T>::mask))>
+  : std::integral_constant<std::uint8_t, read_as<T>::mask> {};
+
+template <typename T, typename = void>
+struct arg_exact : std::false_type {};
+
+template <typename T>
+struct arg_exact<T, decltype(void(read_as<T>::exact))>
+  : std::integral_constant<bool, read_as<T>::exact> {};
+
 } // namespace stack
 } // namespace perlbind
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// perl only makes copy-on-write copies for xs code when given these flags
+#if defined(PERL_ANY_COW) && defined(SV_COW_OTHER_PVS)
+#define PERLBIND_COW_FLAGS (SV_COW_SHARED_HASH_KEYS|SV_COW_OTHER_PVS)
+#endif
+
+namespace perlbind { namespace detail {
+
+// one perl string per distinct native string returned by const reference
+// (opt-in per interpreter). returns are copy-on-write copies of the interned
+// string on perls that support it so its buffer is shared instead of copied.
+// perls without copy-on-write push the read-only interned string itself.
+// when full, strings not returned since the clock hand last passed are evicted
+class string_cache
+{
+public:
+  static const char* key() { return "perlbind::string_cache"; }
+
+  static constexpr std::size_t max_size = 4096;
+
+  explicit string_cache(PerlInterpreter* interp) : my_perl(interp) {}
+  string_cache(const string_cache&) = delete;
+  string_cache& operator=(const string_cache&) = delete;
+  ~string_cache() { clear(); }
+
+  static string_cache& get(PerlInterpreter* my_perl)
+  {
+    return interp_local<string_cache>::get(my_perl);
+  }
+
+  bool enabled() const { return m_enabled; }
+
+  void set_enabled(bool enable)
+  {
+    m_enabled = enable;
+    if (!enable)
+      clear();
+  }
+
+  // returns the interned string for value, evicting another string if full
+  SV* intern(const std::string& value)
+  {
+    auto it = m_index.find(value);
+    if (it != m_index.end())
+    {
+      entry& found = m_entries[it->second];
+      found.referenced = true;
+      return found.sv;
+    }
+
+    SV* sv = newSVpvn(value.c_str(), value.size());
+#ifndef PERLBIND_COW_FLAGS
+    SvREADONLY_on(sv); // pushed to perl directly
+#endif
+
+    if (m_entries.size() < max_size)
+    {
+      auto res = m_index.emplace(value, m_entries.size());
+      m_entries.push_back({ sv, &res.first->first, false });
+      return sv;
+    }
+
+    while (m_entries[m_hand].referenced)
+    {
+      m_entries[m_hand].referenced = false;
+      m_hand = (m_hand + 1) % max_size;
+    }
+
+    // mortal so an evicted string pushed earlier in the statement stays valid
+    entry& evicted = m_entries[m_hand];
+    sv_2mortal(evicted.sv);
+    m_index.erase(m_index.find(*evicted.key));
+
+    auto res = m_index.emplace(value, m_hand);
+    evicted = { sv, &res.first->first, false };
+    m_hand = (m_hand + 1) % max_size;
+    return sv;
+  }
+
+  std::size_t size() const { return m_entries.size(); }
+
+private:
+  struct entry
+  {
+    SV* sv;
+    const std::string* key; // node keys are stable across rehashes
+    bool referenced;
+  };
+
+  void clear()
+  {
+    for (auto& it : m_entries)
+      SvREFCNT_dec(it.sv);
+
+    m_entries.clear();
+    m_index.clear();
+    m_hand = 0;
+  }
+
+  PerlInterpreter* my_perl = nullptr;
+  bool m_enabled = false;
+  std::size_t m_hand = 0; // clock hand over m_entries once full
+  std::vector<entry> m_entries;
+  std::unordered_map<std::string, std::size_t> m_index;
+};
+
+} // namespace detail
+} // namespace perlbind
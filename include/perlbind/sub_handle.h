@@ -0,0 +1,106 @@
+#pragma once
+
+#include <string>
+
+namespace perlbind {
+
+// calls a named perl sub through its CV resolved once instead of looking up the
+// name on each call. the CV is resolved again on the next call if the sub's glob
+// is assigned a different CV or its package's subs change (e.g. a reloaded script)
+// a sub that doesn't exist yet is resolved on first call. handles of anonymous
+// subs (e.g. from interpreter::compile) hold a reference to the CV instead
+class sub_handle
+{
+public:
+  sub_handle() = delete;
+  sub_handle(PerlInterpreter* interp, std::string subname)
+    : my_perl(interp), m_name(std::move(subname))
+  {
+    m_errgv = gv_fetchpvs("@", GV_ADD, SVt_PV);
+  }
+  sub_handle(PerlInterpreter* interp, CV* cv)
+    : my_perl(interp), m_name("__ANON__"), m_cv(reinterpret_cast<CV*>(SvREFCNT_inc(cv))), m_anonymous(true)
+  {
+    m_errgv = gv_fetchpvs("@", GV_ADD, SVt_PV);
+  }
+  sub_handle(const sub_handle& other) = delete;
+  sub_handle(sub_handle&& other) noexcept
+    : my_perl(other.my_perl), m_name(std::move(other.m_name)), m_errgv(other.m_errgv),
+      m_cv(other.m_cv), m_gv(other.m_gv), m_stash(other.m_stash), m_gen(other.m_gen),
+      m_anonymous(other.m_anonymous)
+  {
+    other.m_cv = nullptr;
+    other.m_gv = nullptr;
+  }
+  sub_handle& operator=(const sub_handle& other) = delete;
+  sub_handle& operator=(sub_handle&& other) = delete;
+  ~sub_handle() { release(); }
+
+  const std::string& name() const { return m_name; }
+
+  // returns true if the sub is defined
+  bool exists() { return cv() != nullptr; }
+
+  // returns the resolved CV or nullptr if the sub doesn't exist
+  CV* cv()
+  {
+    if (!m_anonymous && !is_current())
+      resolve();
+
+    return m_cv;
+  }
+
+  template <typename T, typename... Args>
+  T call(Args&&... args)
+  {
+    CV* sub = cv();
+    if (!sub)
+      throw std::runtime_error("Perl error: Undefined subroutine &" + m_name + " called");
+
+    detail::sub_caller caller(my_perl, m_errgv);
+    return caller.call_sub<T>(sub, std::forward<Args>(args)...);
+  }
+
+  PerlInterpreter* my_perl = nullptr;
+
+private:
+  bool is_current() const
+  {
+    return m_cv && GvCV(m_gv) == m_cv && GvSTASH(m_gv) == m_stash && HvMROMETA(m_stash)->pkg_gen == m_gen;
+  }
+
+  void resolve()
+  {
+    release();
+
+    // the named glob is watched rather than CvGV since imported or aliased
+    // subs are owned by another package's glob
+    GV* gv = gv_fetchpvn_flags(m_name.c_str(), m_name.size(), 0, SVt_PVCV);
+    if (!gv || !isGV_with_GP(gv) || !GvCV(gv) || !GvSTASH(gv))
+      return;
+
+    // references keep the CV and glob alive if they're removed from the package
+    m_cv = reinterpret_cast<CV*>(SvREFCNT_inc(GvCV(gv)));
+    m_gv = reinterpret_cast<GV*>(SvREFCNT_inc(gv));
+    m_stash = GvSTASH(m_gv);
+    m_gen = HvMROMETA(m_stash)->pkg_gen;
+  }
+
+  void release()
+  {
+    SvREFCNT_dec(m_cv);
+    SvREFCNT_dec(m_gv);
+    m_cv = nullptr;
+    m_gv = nullptr;
+  }
+
+  std::string m_name;
+  GV* m_errgv = nullptr;
+  CV* m_cv = nullptr;
+  GV* m_gv = nullptr;
+  HV* m_stash = nullptr; // not owned, the glob's stash is cleared if it's freed
+  U32 m_gen = 0;
+  bool m_anonymous = false;
+};
+
+} // namespace perlbind
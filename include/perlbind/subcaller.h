@@ -2,6 +2,10 @@
 
 #include <stdexcept>
 
+#ifndef G_LIST
+#define G_LIST G_ARRAY // perl < 5.35.1
+#endif
+
 namespace perlbind { namespace detail {
 
 // handles calls to perl, inherits stack::pusher to push args to perl sub
@@ -9,7 +13,8 @@ class sub_caller : public stack::pusher
 {
 public:
   sub_caller() = delete;
-  sub_caller(PerlInterpreter* my_perl) : stack::pusher(my_perl)
+  // errgv is the cached glob of $@, looked up by name after each call if null
+  sub_caller(PerlInterpreter* my_perl, GV* errgv = nullptr) : stack::pusher(my_perl), m_errgv(errgv)
   {
     ENTER; // enter scope boundary for any mortals we create
     SAVETMPS;
@@ -21,57 +26,90 @@ public:
     LEAVE; // leave scope, decref mortals and values returned by perl
   }
 
-  template <typename T, typename... Args, std::enable_if_t<std::is_void<T>::value, bool> = true>
-  auto call_sub(const char* subname, Args&&... args)
+  // frees mortals created by calls made so far (calls share the caller's scope)
+  void free_temps()
   {
-    call_sub_impl(subname, G_EVAL|G_VOID, std::forward<Args>(args)...);
+    FREETMPS;
   }
 
-  template <typename T, typename... Args, std::enable_if_t<std::is_integral<T>::value, bool> = true>
-  auto call_sub(const char* subname, Args&&... args)
+  // sub is the name of the sub or its CV
+  template <typename T, typename Sub, typename... Args, std::enable_if_t<std::is_void<T>::value, bool> = true>
+  auto call_sub(Sub sub, Args&&... args)
   {
-    T result = 0;
+    call_sub_impl(sub, G_EVAL|G_VOID, std::forward<Args>(args)...);
+  }
 
-    try
-    {
-      int count = call_sub_impl(subname, G_EVAL|G_SCALAR, std::forward<Args>(args)...);
+  // types with a list reader (containers, tuples, array, hash) call the sub in
+  // list context, others in scalar context. values are converted from the
+  // returned stack slots before they're freed so T can't be a borrowed type
+  template <typename T, typename Sub, typename... Args, std::enable_if_t<!std::is_void<T>::value, bool> = true>
+  T call_sub(Sub sub, Args&&... args)
+  {
+    static_assert(!is_any<T, const char*, scalar_ref, array_ref, hash_ref, perlbind::args, perlbind::kwargs>::value &&
+                  !is_string_view<T>::value,
+                  "call_sub<T> 'T' cannot reference values freed after the call (use std::string or scalar)");
 
-      if (count == 1)
-      {
-        SV* sv_result = pop();
-        result = static_cast<T>(SvIV(sv_result));
-      }
-    }
-    catch (...)
-    {
-      pop(); // top of stack holds undef on error when called with these flags
-      throw;
-    }
+    using is_list = stack::has_list_reader<T>;
+    int count = call_sub_impl(sub, G_EVAL|(is_list::value ? G_LIST : G_SCALAR), std::forward<Args>(args)...);
 
-    return result;
+    // returned values stay in their slots after popping until the caller's
+    // scope frees them, popped first so they're discarded if conversion throws
+    int ax = static_cast<int>(sp - PL_stack_base) - count + 1;
+    sp -= count;
+    return read_result<T>(ax, count, is_list());
   }
 
 private:
-  template <typename... Args>
-  int call_sub_impl(const char* subname, int flags, Args&&... args)
+  // a single value is always returned in scalar context
+  template <typename T>
+  T read_result(int ax, int count, std::false_type)
+  {
+    return stack::get_scalar_return<T>(my_perl, ax);
+  }
+
+  template <typename T>
+  T read_result(int ax, int count, std::true_type)
   {
+    return stack::read_list<T>::get(my_perl, ax, count);
+  }
+
+  int call_perl(const char* subname, int flags) { return call_pv(subname, flags); }
+  int call_perl(CV* cv, int flags) { return call_sv(reinterpret_cast<SV*>(cv), flags); }
+
+  template <typename Sub, typename... Args>
+  int call_sub_impl(Sub sub, int flags, Args&&... args)
+  {
+    SSize_t base = sp - PL_stack_base; // pushing may reallocate the stack
     PUSHMARK(SP); // notify perl of local sp (required even if not pushing args)
-    push_args(std::forward<Args>(args)...);
+    try
+    {
+      push_args(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      // restore the mark and stack so the caller can still be used
+      POPMARK;
+      sp = PL_stack_base + base;
+      throw;
+    }
     PUTBACK; // set global sp back to local so call will know pushed arg count
 
-    int result_count = call_pv(subname, flags);
+    int result_count = call_perl(sub, flags);
 
     SPAGAIN; // refresh local sp since call may reallocate stack for scalar returns
 
-    // ERRSV doesn't work in perl 5.28+ here for unknown reasons
-    SV* err = get_sv("@", 0);
+    // ERRSV doesn't work in perl 5.28+ here for unknown reasons, read from glob
+    SV* err = m_errgv ? GvSVn(m_errgv) : get_sv("@", 0);
     if (SvTRUE(err))
     {
+      sp -= result_count; // undef is returned on error in scalar context
       throw std::runtime_error("Perl error: " + std::string(SvPV_nolen(err)));
     }
 
     return result_count;
   }
+
+  GV* m_errgv = nullptr;
 };
 
 } //namespace detail
@@ -1,5 +1,14 @@
 #pragma once
 
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace perlbind { namespace detail {
 
 template<typename T, typename... Rest>
@@ -29,5 +38,79 @@ struct is_last<T, Last> : std::is_same<T, Last> {};
 template <typename T, typename Next, typename... Args>
 struct is_last<T, Next, Args...> : std::integral_constant<bool, is_last<T, Args...>::value> {};
 
+template <bool... B>
+struct bool_pack {};
+template <bool... B>
+struct all_true : std::is_same<bool_pack<true, B...>, bool_pack<B..., true>> {};
+
+template <typename T>
+struct is_smart_ptr : std::false_type {};
+template <typename T>
+struct is_smart_ptr<std::shared_ptr<T>> : std::true_type {};
+template <typename T, typename D>
+struct is_smart_ptr<std::unique_ptr<T, D>> : std::true_type {};
+
+template <typename T>
+struct is_string_view : std::false_type {};
+#ifdef __cpp_lib_string_view
+template <>
+struct is_string_view<std::string_view> : std::true_type {};
+#endif
+
+// native containers converted to and from perl arrays
+template <typename T>
+struct is_list_container : std::false_type {};
+template <typename T, typename A>
+struct is_list_container<std::vector<T, A>> : std::true_type {};
+template <typename T, std::size_t N>
+struct is_list_container<std::array<T, N>> : std::true_type {};
+template <typename T1, typename T2>
+struct is_list_container<std::pair<T1, T2>> : std::true_type {};
+template <typename... Args>
+struct is_list_container<std::tuple<Args...>> : std::true_type {};
+
+// native containers converted to and from perl hashes
+template <typename T>
+struct is_map_container : std::false_type {};
+template <typename K, typename V, typename C, typename A>
+struct is_map_container<std::map<K, V, C, A>> : std::true_type {};
+template <typename K, typename V, typename H, typename E, typename A>
+struct is_map_container<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+template <typename T>
+struct is_tuple : std::false_type {};
+template <typename T1, typename T2>
+struct is_tuple<std::pair<T1, T2>> : std::true_type {};
+template <typename... Args>
+struct is_tuple<std::tuple<Args...>> : std::true_type {};
+
+template <typename T>
+struct is_container : std::integral_constant<bool, is_list_container<T>::value || is_map_container<T>::value> {};
+
+template <typename T>
+struct is_as_ref : std::false_type {};
+template <typename T>
+struct is_as_ref<as_ref<T>> : std::true_type {};
+
+template <typename T>
+struct is_nullable : std::false_type {};
+template <typename T>
+struct is_nullable<nullable<T>> : std::true_type {};
+
+// class types read by reference as objects of a registered class (not perl types)
+template <typename T>
+struct is_object_class : std::integral_constant<bool, std::is_class<T>::value &&
+                                                      !std::is_base_of<type_base, T>::value &&
+                                                      !is_any<T, std::string, scalar_proxy, scalar_ref, array_ref, hash_ref, args, kwargs>::value &&
+                                                      !is_smart_ptr<T>::value &&
+                                                      !is_string_view<T>::value &&
+                                                      !is_container<T>::value &&
+                                                      !is_as_ref<T>::value &&
+                                                      !is_nullable<T>::value> {};
+
+// registered classes passed and returned by value (opt-in with perlbind::by_value<T>)
+template <typename T>
+struct is_value_object : std::integral_constant<bool, is_object_class<T>::value && by_value<T>::value> {};
+
 } // namespace detail
 } // namespace perlbind
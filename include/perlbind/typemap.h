@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace perlbind { namespace detail {
 
 struct usertype_counter
@@ -14,30 +19,262 @@ struct usertype_counter
 template <typename T>
 struct usertype
 {
-  static std::string id()
+  static std::size_t id()
   {
     static std::size_t id = usertype_counter::next_id();
-    return std::to_string(id);
+    return id;
   }
 };
 
 namespace typemap
 {
-  // type names are stored in a hash on interpreter when registered with
-  // unique id keys generated by usertype counter
-  inline hash get(PerlInterpreter* my_perl)
+  struct entry
+  {
+    std::string name;
+    HV* stash = nullptr; // nullptr if type isn't registered, holds a reference
+    bool typed_handles = false; // objects are pushed with handle magic
+    bool identity_map = false; // objects are reused for the same pointer
+  };
+
+  // registered type names and stashes of an interpreter indexed by the unique
+  // ids generated by usertype counter
+  struct table
+  {
+    static const char* key() { return "perlbind::typemap"; }
+
+    explicit table(PerlInterpreter* interp) : my_perl(interp) {}
+    table(const table&) = delete;
+    table& operator=(const table&) = delete;
+    ~table()
+    {
+      for (auto& type : m_entries)
+        SvREFCNT_dec(type.stash);
+    }
+
+    const entry* find(std::size_t type_id) const
+    {
+      return type_id < m_entries.size() && m_entries[type_id].stash ? &m_entries[type_id] : nullptr;
+    }
+
+    void insert(std::size_t type_id, const char* name, HV* stash)
+    {
+      if (type_id >= m_entries.size())
+        m_entries.resize(type_id + 1);
+
+      // referenced so objects aren't blessed into a freed stash if a script
+      // deletes the package
+      SvREFCNT_inc_simple_void_NN(stash);
+      SvREFCNT_dec(m_entries[type_id].stash);
+      m_entries[type_id].name = name;
+      m_entries[type_id].stash = stash;
+      invalidate();
+    }
+
+    void set_typed_handles(std::size_t type_id, bool enabled)
+    {
+      if (type_id < m_entries.size())
+        m_entries[type_id].typed_handles = enabled;
+    }
+
+    void set_identity_map(std::size_t type_id, bool enabled)
+    {
+      if (type_id < m_entries.size())
+        m_entries[type_id].identity_map = enabled;
+    }
+
+    // returns if object reference is derived from the registered type. results
+    // are cached per object stash until perl's method cache generation for the
+    // stash changes (bumped by @ISA changes in the stash or any of its parents)
+    bool derived_from(PerlInterpreter* my_perl, SV* ref, const entry& type, std::size_t type_id)
+    {
+      HV* stash = SvSTASH(SvRV(ref));
+      if (stash == type.stash)
+        return true;
+
+      const struct mro_meta* meta = HvMROMETA(stash);
+      auto& cached = m_derived[{ stash, type_id }];
+      if (cached.valid && cached.cache_gen == meta->cache_gen && cached.sub_gen == PL_sub_generation)
+        return cached.derived;
+
+      // sv_derived_from may re-create the meta (and cached generation) of the stash
+      cached.derived = sv_derived_from_pvn(ref, type.name.c_str(), type.name.size(), 0);
+      cached.cache_gen = HvMROMETA(stash)->cache_gen;
+      cached.sub_gen = PL_sub_generation;
+      cached.valid = true;
+      return cached.derived;
+    }
+
+    // drops cached inheritance checks
+    void invalidate() { m_derived.clear(); }
+
+  private:
+    struct derived_key
+    {
+      HV* stash;
+      std::size_t type_id;
+
+      bool operator==(const derived_key& other) const
+      {
+        return stash == other.stash && type_id == other.type_id;
+      }
+    };
+
+    struct derived_hash
+    {
+      std::size_t operator()(const derived_key& key) const
+      {
+        return std::hash<HV*>()(key.stash) ^ (key.type_id * 0x9e3779b9);
+      }
+    };
+
+    struct derived_result
+    {
+      U32 cache_gen = 0;
+      U32 sub_gen = 0;
+      bool derived = false;
+      bool valid = false;
+    };
+
+    PerlInterpreter* my_perl = nullptr;
+    std::vector<entry> m_entries;
+    std::unordered_map<derived_key, derived_result, derived_hash> m_derived;
+  };
+
+  inline table& get(PerlInterpreter* my_perl)
+  {
+    return interp_local<table>::get(my_perl);
+  }
+
+  template <typename T>
+  const entry* find(PerlInterpreter* my_perl)
   {
-    HV* hv = get_hv("__perlbind::typemap", GV_ADD);
-    return reinterpret_cast<HV*>(SvREFCNT_inc(hv));
+    return get(my_perl).find(detail::template usertype<T>::id());
   }
 
   template <typename T>
   const char* get_name(PerlInterpreter* my_perl)
   {
-    auto typemap = detail::typemap::get(my_perl);
-    auto type_id = detail::template usertype<T>::id();
+    const entry* type = find<T>(my_perl);
+    return type ? type->name.c_str() : nullptr;
+  }
+
+  template <typename T>
+  HV* get_stash(PerlInterpreter* my_perl)
+  {
+    const entry* type = find<T>(my_perl);
+    return type ? type->stash : nullptr;
+  }
+
+  // reads the pointer of an object derived from the registered type T
+  // returns false if sv isn't a compatible object. handles are matched by their
+  // type id and objects without handle magic are rejected for typed handle types
+  // invalidated objects are rejected for all types
+  // owner is set to the smart pointer of objects owned by perl or nullptr
+  template <typename T>
+  bool get_object(PerlInterpreter* my_perl, SV* sv, T& value, const std::shared_ptr<void>** owner = nullptr)
+  {
+    if (!sv_isobject(sv))
+      return false;
+
+    table& types = get(my_perl);
+    std::size_t type_id = detail::template usertype<T>::id();
+    const entry* type = types.find(type_id);
+    if (!type)
+      return false;
+
+    SV* obj = SvRV(sv);
+    if (const MAGIC* mg = handle::find(my_perl, obj))
+    {
+      if (handle::is_invalidated(mg))
+        return false;
+
+      if (handle::get_type_id(mg) != type_id && !types.derived_from(my_perl, sv, *type, type_id))
+        return false;
+
+      value = static_cast<T>(handle::get_ptr(mg));
+      if (owner)
+        *owner = handle::get_owner(mg);
+      return true;
+    }
+
+    if (type->typed_handles || !types.derived_from(my_perl, sv, *type, type_id))
+      return false;
+
+    value = INT2PTR(T, SvIV(obj));
+    if (owner)
+      *owner = nullptr;
+    return true;
+  }
+
+  // sets sv to a new object reference of the registered type T or undef if null
+  // returns false and leaves sv unchanged if the type isn't registered
+  // objects with an owner are held by perl until the object is freed
+  template <typename T>
+  bool set_object(PerlInterpreter* my_perl, SV* sv, T value, std::shared_ptr<void> owner = nullptr)
+  {
+    std::size_t type_id = detail::template usertype<T>::id();
+    const entry* type = get(my_perl).find(type_id);
+    if (!type)
+      return false;
 
-    return typemap.exists(type_id) ? typemap[type_id].c_str() : nullptr;
+    // null pointers are undef like sv_setref_pv
+    void* ptr = const_cast<void*>(static_cast<const void*>(value));
+    if (!ptr)
+    {
+      sv_setsv(sv, &PL_sv_undef);
+      return true;
+    }
+
+    if (type->identity_map)
+    {
+      // an owned object is only reused if its existing object holds an owner
+      SV* obj = identity_map::get(my_perl).find(ptr, type_id);
+      const MAGIC* mg = obj && owner ? handle::find(my_perl, obj) : nullptr;
+      if (obj && (!owner || (mg && handle::is_owned(mg))))
+      {
+        set_ref(my_perl, sv, obj);
+        return true;
+      }
+    }
+
+    // blessed with the registered stash to avoid a stash lookup by name
+    SV* obj = newSVrv(sv, nullptr);
+    sv_setiv(obj, PTR2IV(ptr));
+    if (owner)
+      handle::attach(my_perl, obj, ptr, type_id, std::move(owner));
+    else if (type->typed_handles)
+      handle::attach(my_perl, obj, ptr, type_id);
+
+    sv_bless(sv, type->stash);
+
+    if (type->identity_map)
+      identity_map::get(my_perl).insert(ptr, type_id, obj);
+
+    return true;
+  }
+
+  // sets sv to a new object reference of the registered type T that stores a
+  // copy of value in its handle. returns false if the type isn't registered
+  template <typename T>
+  bool set_value(PerlInterpreter* my_perl, SV* sv, T&& value)
+  {
+    using value_t = std::decay_t<T>;
+    std::size_t type_id = detail::template usertype<value_t*>::id();
+    const entry* type = get(my_perl).find(type_id);
+    if (!type)
+      return false;
+
+    SV* obj = newSVrv(sv, nullptr);
+    value_t* ptr = handle::attach_value<value_t>(my_perl, obj, type_id, std::forward<T>(value));
+    sv_setiv(obj, PTR2IV(ptr));
+    sv_bless(sv, type->stash);
+    return true;
+  }
+
+  template <typename T>
+  void add(PerlInterpreter* my_perl, const char* name)
+  {
+    get(my_perl).insert(detail::template usertype<T>::id(), name, gv_stashpv(name, GV_ADD));
   }
 } // namespace typemap
 
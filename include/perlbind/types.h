@@ -22,4 +22,45 @@ private:
   T m_ptr = nullptr;
 };
 
+// registered classes are only passed and returned by value (copied into the
+// perl object) if they opt in by specializing this as std::true_type
+template <typename T>
+struct by_value : std::false_type {};
+
+// how a function binding's return value is pushed for the calling context
+// count and reference only change scalar context returns of lists (native
+// containers, tuples, perlbind::array and perlbind::hash)
+enum class return_policy
+{
+  automatic, // pushed in every context (lists are flattened)
+  skip_void, // not converted or pushed in void context
+  count,     // skip_void, lists return their element count in scalar context
+  reference, // skip_void, lists return an array or hash reference in scalar context
+};
+
+// how each item is passed to a perl sub called by interpreter::multicall
+enum class multicall_arg
+{
+  topic, // aliased to $_
+  args,  // aliased to @_ (tuples and pairs are passed as multiple arguments)
+};
+
+// error of a failed call made by interpreter::call_batch
+struct batch_error
+{
+  std::size_t index; // index of the call in the batch
+  std::string message;
+};
+
+// helper type to return a native container as a reference instead of a list
+// e.g. perlbind::as_ref<std::vector<int>> get_ids() returns an array reference
+template <typename T>
+struct as_ref
+{
+  static_assert(detail::is_container<T>::value, "as_ref<T> 'T' must be a supported container");
+
+  as_ref(T container) : value(std::move(container)) {}
+  T value;
+};
+
 } // namespace perlbind
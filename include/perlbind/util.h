@@ -2,6 +2,11 @@
 
 #include <string>
 #include <typeinfo>
+#if defined(__has_include)
+#if __has_include(<string_view>)
+#include <string_view> // defines __cpp_lib_string_view if std::string_view is available
+#endif
+#endif
 #ifndef _MSC_VER
 #include <cxxabi.h>
 #endif
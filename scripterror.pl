@@ -0,0 +1 @@
+1 $test_syntax_error = 1
\ No newline at end of file
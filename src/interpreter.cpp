@@ -1,5 +1,6 @@
 #include <perlbind/perlbind.h>
 
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -72,7 +73,7 @@ void interpreter::load_script(std::string packagename, std::string filename)
 
   try
   {
-    eval(buffer.str().c_str());
+    eval_source(buffer.str().c_str());
   }
   catch (std::exception& e)
   {
@@ -81,6 +82,106 @@ void interpreter::load_script(std::string packagename, std::string filename)
 }
 
 void interpreter::eval(const char* str)
+{
+  auto& cache = detail::eval_cache::get(my_perl);
+  if (cache.capacity() == 0)
+  {
+    eval_source(str);
+    return;
+  }
+
+  std::size_t len = std::strlen(str);
+  std::uint64_t hash = detail::eval_cache::hash(str, len);
+  CV* cv = nullptr;
+  if (!cache.find(str, len, hash, cv))
+  {
+    // strings that can't be wrapped in a sub body (__END__, __DATA__ or pod)
+    // and strings that fail to compile are cached without a sub and evaluated
+    // uncached. a failed compile isn't evaluated again so BEGIN blocks and sub
+    // definitions only run once
+    if (detail::eval_cache::can_wrap(str, len))
+    {
+      try
+      {
+        sub_handle handle = compile(str);
+        cv = handle.cv();
+        cache.insert(str, len, hash, cv); // cache holds the sub after handle is freed
+      }
+      catch (std::runtime_error&)
+      {
+        cache.insert(str, len, hash, nullptr);
+        throw;
+      }
+    }
+    else
+    {
+      cache.insert(str, len, hash, nullptr);
+    }
+  }
+
+  if (!cv)
+  {
+    eval_source(str);
+    return;
+  }
+
+  std::string error;
+
+  ENTER;
+  SAVETMPS;
+  SAVEFREESV(SvREFCNT_inc_simple_NN(cv)); // in case a nested eval evicts it
+
+  dSP;
+  PUSHMARK(SP);
+  PUTBACK;
+
+  call_sv(reinterpret_cast<SV*>(cv), G_VOID | G_DISCARD | G_EVAL);
+
+  // read from glob, ERRSV doesn't work in perl 5.28+ (see sub_caller)
+  SV* err = get_sv("@", 0);
+  if (err && SvTRUE(err))
+    error = SvPV_nolen(err);
+
+  FREETMPS;
+  LEAVE;
+
+  if (!error.empty())
+    throw std::runtime_error(error);
+}
+
+sub_handle interpreter::compile(const std::string& code)
+{
+  // newline before the closing brace in case code ends with a comment
+  std::string source = "sub { " + code + "\n}";
+  std::string error;
+  CV* cv = nullptr;
+
+  ENTER;
+  SAVETMPS;
+
+  SV* sv = eval_pv(source.c_str(), 0);
+  if (SvROK(sv) && SvTYPE(SvRV(sv)) == SVt_PVCV)
+  {
+    cv = reinterpret_cast<CV*>(SvREFCNT_inc(SvRV(sv)));
+  }
+  else
+  {
+    SV* err = get_sv("@", 0);
+    error = err && SvTRUE(err) ? SvPV_nolen(err) : "unknown error in compile()";
+  }
+
+  FREETMPS;
+  LEAVE;
+
+  if (!cv)
+    throw std::runtime_error(error);
+
+  sub_handle handle(my_perl, cv);
+  SvREFCNT_dec(cv);
+  return handle;
+}
+
+void interpreter::eval_source(const char* str)
 {
   SV* sv = eval_pv(str, 0);
   if (sv == &PL_sv_undef)
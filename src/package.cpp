@@ -1,40 +1,206 @@
 #include <perlbind/perlbind.h>
 
+#include <array>
+#include <vector>
+
 namespace perlbind {
 
 namespace detail {
   extern "C" void xsub(PerlInterpreter* my_perl, CV* cv);
+
+  // dispatch table of a CV's overloads, built on registration so calls only
+  // check functions with a matching stack arity. varargs are merged into each
+  // arity group to keep the registered priority of overloads. resolved
+  // overloads are cached by argument kinds until another overload is added
+  class overload_set
+  {
+  public:
+    static constexpr int max_kinds = 16; // larger stacks fallback to full checks
+    static constexpr int max_cache = 4;
+    static constexpr int max_cache_items = 7; // kinds and item count packed in cache key
+
+    overload_set() = default;
+    overload_set(const overload_set&) = delete;
+    overload_set& operator=(const overload_set&) = delete;
+    ~overload_set()
+    {
+      for (auto func : m_functions)
+        delete func;
+    }
+
+    void add(function_base* function)
+    {
+      m_functions.push_back(function);
+      m_cache = {};
+      m_cache_next = 0;
+
+      int max_arity = 0;
+      m_varargs.clear();
+      for (auto func : m_functions)
+      {
+        if (func->dispatch().is_vararg)
+          m_varargs.push_back(func);
+        else
+          max_arity = std::max(max_arity, func->dispatch().arity);
+      }
+
+      m_arity.assign(max_arity + 1, {});
+      for (auto func : m_functions)
+      {
+        for (int arity = 0; arity <= max_arity; ++arity)
+        {
+          if (func->dispatch().is_vararg || func->dispatch().arity == arity)
+            m_arity[arity].push_back(func);
+        }
+      }
+    }
+
+    // calls first compatible overload in registered order, returns false if none
+    bool call(xsub_stack& stack)
+    {
+      int items = stack.size();
+      const auto& candidates = items < static_cast<int>(m_arity.size()) ? m_arity[items] : m_varargs;
+
+      std::uint8_t kinds[max_kinds];
+      if (items > max_kinds || !stack.get_kinds(kinds, items))
+      {
+        for (auto func : candidates)
+        {
+          if (func->dispatch().is_vararg)
+          {
+            func->call(stack);
+            return true;
+          }
+          if (func->try_call(stack))
+            return true;
+        }
+        return false;
+      }
+
+      // calls with the same argument kinds resolve to the same overload, a
+      // cached overload that needed a full check is checked again on a hit
+      std::uint64_t key = make_key(kinds, items);
+      for (const auto& entry : m_cache)
+      {
+        if (key != 0 && entry.key == key)
+        {
+          if (!entry.verify)
+          {
+            entry.func->call(stack);
+            return true;
+          }
+          if (entry.func->try_call(stack))
+            return true;
+          break;
+        }
+      }
+
+      bool cacheable = key != 0;
+      for (auto func : candidates)
+      {
+        const dispatch_info& info = func->dispatch();
+        if (!info.is_vararg)
+        {
+          int i = 0;
+          while (i < items && (info.masks[i] & kinds[i]))
+            ++i;
+
+          if (i != items)
+            continue;
+
+          // arguments are checked and converted once for the call
+          if (!info.is_exact)
+          {
+            if (!func->try_call(stack))
+            {
+              cacheable = false; // may match for different values of the same kinds
+              continue;
+            }
+            if (cacheable)
+              add_cache(key, func, true);
+            return true;
+          }
+        }
+
+        if (cacheable)
+          add_cache(key, func, false);
+        func->call(stack);
+        return true;
+      }
+      return false;
+    }
+
+    const std::vector<function_base*>& functions() const { return m_functions; }
+
+    static const MGVTBL mgvtbl;
+
+  private:
+    struct cache_entry
+    {
+      std::uint64_t key;
+      function_base* func;
+      bool verify;
+    };
+
+    // returns key of stack item count and kinds, 0 if too many items to cache
+    static std::uint64_t make_key(const std::uint8_t* kinds, int items)
+    {
+      if (items > max_cache_items)
+        return 0;
+
+      std::uint64_t key = static_cast<std::uint64_t>(items + 1);
+      for (int i = 0; i < items; ++i)
+        key |= static_cast<std::uint64_t>(kinds[i]) << ((i + 1) * 8);
+
+      return key;
+    }
+
+    void add_cache(std::uint64_t key, function_base* func, bool verify)
+    {
+      m_cache[m_cache_next] = { key, func, verify };
+      m_cache_next = (m_cache_next + 1) % max_cache;
+    }
+
+    std::array<cache_entry, max_cache> m_cache = {};
+    int m_cache_next = 0;
+    std::vector<function_base*> m_functions; // owned, registered order
+    std::vector<std::vector<function_base*>> m_arity; // indexed by stack arity
+    std::vector<function_base*> m_varargs;
+  };
+
+  extern "C" int free_overload_set(pTHX_ SV* sv, MAGIC* mg)
+  {
+    delete reinterpret_cast<overload_set*>(mg->mg_ptr);
+    return 1;
+  }
+
+  const MGVTBL overload_set::mgvtbl = { 0, 0, 0, 0, free_overload_set, 0, 0, 0 };
 } // namespace detail
 
-void package::add_impl(const char* name, detail::function_base* function)
+void package::add_impl(const char* name, detail::function_base* function, XSUBADDR_t xsub)
 {
   std::string export_name = m_name + "::" + name;
 
-  // the sv is assigned a magic metamethod table to delete the function
-  // object when perl frees the sv
-  SV* sv = newSViv(PTR2IV(function));
-  sv_magicext(sv, nullptr, PERL_MAGIC_ext, &detail::function_base::mgvtbl, nullptr, 0);
-
   CV* cv = get_cv(export_name.c_str(), 0);
-  if (!cv)
+  MAGIC* mg = cv ? mg_findext(reinterpret_cast<SV*>(cv), PERL_MAGIC_ext, &detail::overload_set::mgvtbl) : nullptr;
+  if (!mg)
   {
-    cv = newXS(export_name.c_str(), &detail::xsub, __FILE__);
+    // a single function is called directly by its own xsub entry
+    // the CV owns its overload set through magic that deletes it when freed
+    auto overloads = new detail::overload_set();
+    cv = newXS(export_name.c_str(), xsub, __FILE__);
+    mg = sv_magicext(reinterpret_cast<SV*>(cv), nullptr, PERL_MAGIC_ext, &detail::overload_set::mgvtbl,
+                     reinterpret_cast<const char*>(overloads), 0);
     CvXSUBANY(cv).any_ptr = function;
   }
-  else // function exists, remove target to search overloads when called
-  {
-    CvXSUBANY(cv).any_ptr = nullptr;
-  }
-
-  // create an array with same name to store overloads in the CV's GV
-  AV* av = GvAV(CvGV(cv));
-  if (!av)
+  else // function exists, fallback to searching overloads when called
   {
-    av = get_av(export_name.c_str(), GV_ADD);
+    CvXSUB(cv) = &detail::xsub;
+    CvXSUBANY(cv).any_ptr = mg->mg_ptr;
   }
 
-  array overloads = reinterpret_cast<AV*>(SvREFCNT_inc(av));
-  overloads.push_back(sv); // giving only ref to GV array
+  // ownership of function object is given to the overload set
+  reinterpret_cast<detail::overload_set*>(mg->mg_ptr)->add(function);
 }
 
 extern "C" void detail::xsub(PerlInterpreter* my_perl, CV* cv)
@@ -44,31 +210,17 @@ extern "C" void detail::xsub(PerlInterpreter* my_perl, CV* cv)
   {
     detail::xsub_stack stack(my_perl, cv);
 
-    auto target = static_cast<detail::function_base*>(CvXSUBANY(cv).any_ptr);
-    if (target)
+    auto overloads = static_cast<detail::overload_set*>(CvXSUBANY(cv).any_ptr);
+    if (overloads->call(stack))
     {
-      return target->call(stack);
-    }
-
-    // find first compatible overload
-    AV* av = GvAV(CvGV(cv));
-
-    array functions = reinterpret_cast<AV*>(SvREFCNT_inc(av));
-    for (const auto& function : functions)
-    {
-      auto func = INT2PTR(detail::function_base*, SvIV(function.sv()));
-      if (func->is_compatible(stack))
-      {
-        return func->call(stack);
-      }
+      return;
     }
 
     SV* err = newSVpvf("no overload of '%s' matched the %d argument(s):\n (%s)\ncandidates:\n ",
                        stack.name().c_str(), stack.size(), stack.types().c_str());
 
-    for (const auto& function : functions)
+    for (auto func : overloads->functions())
     {
-      auto func = INT2PTR(detail::function_base*, SvIV(function.sv()));
       Perl_sv_catpvf(aTHX_ err, "%s\n ", func->get_signature().c_str());
     }
 
@@ -0,0 +1,456 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <perlbind/perlbind.h>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+extern std::unique_ptr<perlbind::interpreter> interp;
+
+// benchmarks are hidden from default test runs, use the [benchmark] tag to run them
+// each perl sub makes 1000 calls to a binding so results are per 1000 calls
+
+namespace {
+
+template <size_t>
+using int_arg = int;
+
+template <typename... Args>
+int count_args(Args...) { return sizeof...(Args); }
+
+template <size_t... I>
+auto count_args_fn(std::index_sequence<I...>) { return &count_args<int_arg<I>...>; }
+
+// binds overloads accepting 1 to N int arguments to the same name
+template <size_t... N>
+void add_count_overloads(perlbind::package& package, const char* name, std::index_sequence<N...>)
+{
+  (void)std::initializer_list<int>{
+    (package.add(name, count_args_fn(std::make_index_sequence<N + 1>())), 0)... };
+}
+
+// creates a perl sub that calls the binding 1000 times with count int arguments
+void make_bench_sub(const std::string& subname, const std::string& binding, size_t count)
+{
+  std::string args;
+  for (size_t i = 0; i < count; ++i)
+    args += (i == 0) ? "1" : ", 1";
+
+  std::string code = "sub " + subname + " { for (1..1000) { " + binding + "(" + args + "); } }";
+  interp->eval(code.c_str());
+}
+
+struct bench_npc
+{
+  int get_level() { return m_level; }
+  int m_level = 50;
+};
+
+struct bench_merchant : bench_npc {};
+struct bench_mapped_npc : bench_npc {};
+
+bench_npc g_bench_npc;
+bench_merchant g_bench_merchant;
+bench_npc* get_bench_npc() { return &g_bench_npc; }
+bench_merchant* get_bench_merchant() { return &g_bench_merchant; }
+bench_mapped_npc* get_bench_mapped_npc() { static bench_mapped_npc npc; return &npc; }
+int get_bench_value() { return 1; }
+std::string get_bench_name() { return "a_moderately_long_npc_name"; }
+const std::string& get_bench_description() { static const std::string desc(2000, 'd'); return desc; }
+
+std::vector<int> get_bench_ids() { return std::vector<int>(5000, 1); }
+perlbind::as_ref<std::vector<int>> get_bench_ids_ref() { return get_bench_ids(); }
+perlbind::reference get_bench_ids_array()
+{
+  // manual conversion bindings used before native container support
+  perlbind::array arr;
+  for (int id : get_bench_ids())
+    arr.push_back(id);
+  return perlbind::reference(arr);
+}
+
+std::tuple<float, float, float> get_bench_loc() { return std::make_tuple(1.0f, 2.0f, 3.0f); }
+perlbind::reference get_bench_loc_hash()
+{
+  perlbind::hash loc;
+  loc["x"] = 1.0f;
+  loc["y"] = 2.0f;
+  loc["z"] = 3.0f;
+  return perlbind::reference(loc);
+}
+
+struct bench_pos { float x, y, z; };
+bench_pos make_bench_pos() { return { 1.0f, 2.0f, 3.0f }; }
+std::shared_ptr<bench_pos> make_shared_bench_pos() { return std::make_shared<bench_pos>(bench_pos{ 1.0f, 2.0f, 3.0f }); }
+
+} // namespace
+
+namespace perlbind { template <> struct by_value<bench_pos> : std::true_type {}; }
+
+TEST_CASE("overload dispatch call latency", "[benchmark][.]")
+{
+  // the overload taking the most arguments is registered last (worst case for a linear search)
+  auto package = interp->new_package("bench");
+  add_count_overloads(package, "overloads1", std::make_index_sequence<1>());
+  add_count_overloads(package, "overloads2", std::make_index_sequence<2>());
+  add_count_overloads(package, "overloads4", std::make_index_sequence<4>());
+  add_count_overloads(package, "overloads8", std::make_index_sequence<8>());
+
+  make_bench_sub("bench::call_overloads1", "bench::overloads1", 1);
+  make_bench_sub("bench::call_overloads2", "bench::overloads2", 2);
+  make_bench_sub("bench::call_overloads4", "bench::overloads4", 4);
+  make_bench_sub("bench::call_overloads8", "bench::overloads8", 8);
+
+  BENCHMARK("1 overload") { interp->call_sub<void>("bench::call_overloads1"); };
+  BENCHMARK("2 overloads") { interp->call_sub<void>("bench::call_overloads2"); };
+  BENCHMARK("4 overloads") { interp->call_sub<void>("bench::call_overloads4"); };
+  BENCHMARK("8 overloads") { interp->call_sub<void>("bench::call_overloads8"); };
+}
+
+TEST_CASE("overload registration memory", "[benchmark][.]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("bench");
+
+  // each registration should only add native storage to the sub's overload set
+  IV sv_count = PL_sv_count;
+  add_count_overloads(package, "memory_overloads", std::make_index_sequence<8>());
+  IV first_sv_count = PL_sv_count - sv_count;
+
+  sv_count = PL_sv_count;
+  add_count_overloads(package, "memory_overloads", std::make_index_sequence<8>());
+  WARN("SVs allocated for first 8 overloads (creates sub): " << first_sv_count);
+  WARN("SVs allocated for next 8 overloads: " << PL_sv_count - sv_count);
+}
+
+TEST_CASE("single function call latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_value", &get_bench_value);
+  package.add("get_npc", &get_bench_npc);
+
+  package.add<decltype(&get_bench_value), &get_bench_value>("get_bound_value");
+
+  auto npc_class = interp->new_class<bench_npc>("bench_npc");
+  npc_class.add("get_level", &bench_npc::get_level);
+  npc_class.add<decltype(&bench_npc::get_level), &bench_npc::get_level>("get_bound_level");
+
+  interp->eval(R"script(
+    sub bench::call_get_value { for (1..1000) { bench::get_value(); } }
+    sub bench::call_get_bound_value { for (1..1000) { bench::get_bound_value(); } }
+    sub bench::call_get_level { my $npc = bench::get_npc(); for (1..1000) { $npc->get_level(); } }
+    sub bench::call_get_bound_level { my $npc = bench::get_npc(); for (1..1000) { $npc->get_bound_level(); } }
+  )script");
+
+  BENCHMARK("function getter") { interp->call_sub<void>("bench::call_get_value"); };
+  BENCHMARK("function getter (compile time bound)") { interp->call_sub<void>("bench::call_get_bound_value"); };
+  BENCHMARK("member getter") { interp->call_sub<void>("bench::call_get_level"); };
+  BENCHMARK("member getter (compile time bound)") { interp->call_sub<void>("bench::call_get_bound_level"); };
+}
+
+TEST_CASE("scalar return allocations", "[benchmark][.]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("bench");
+  package.add("get_value", &get_bench_value);
+  package.add("get_name", &get_bench_name);
+  package.add("tmps_ix", [my_perl]() -> int { return static_cast<int>(PL_tmps_ix); });
+
+  // mortals are counted within a single statement before they're freed
+  interp->eval(R"script(
+    sub bench::count_value_mortals { my @t = (bench::tmps_ix(), bench::get_value(), bench::tmps_ix()); return $t[2] - $t[0]; }
+    sub bench::count_name_mortals { my @t = (bench::tmps_ix(), bench::get_name(), bench::tmps_ix()); return $t[2] - $t[0]; }
+    sub bench::call_return_value { for (1..1000) { my $value = bench::get_value(); } }
+    sub bench::call_return_name { for (1..1000) { my $name = bench::get_name(); } }
+  )script");
+
+  WARN("mortal SVs allocated per int return: " << interp->call_sub<int>("bench::count_value_mortals"));
+  WARN("mortal SVs allocated per string return: " << interp->call_sub<int>("bench::count_name_mortals"));
+
+  BENCHMARK("int return") { interp->call_sub<void>("bench::call_return_value"); };
+  BENCHMARK("string return") { interp->call_sub<void>("bench::call_return_name"); };
+}
+
+TEST_CASE("interned string return latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_description", &get_bench_description);
+
+  interp->eval(R"script(
+    sub bench::call_get_description { for (1..1000) { my $desc = bench::get_description(); } }
+  )script");
+
+  BENCHMARK("const string& return") { interp->call_sub<void>("bench::call_get_description"); };
+
+  interp->use_string_interning();
+  BENCHMARK("const string& return (interned)") { interp->call_sub<void>("bench::call_get_description"); };
+  interp->use_string_interning(false);
+}
+
+TEST_CASE("container conversion latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_ids", &get_bench_ids);
+  package.add("get_ids_ref", &get_bench_ids_ref);
+  package.add("get_ids_array", &get_bench_ids_array);
+  package.add("count_ids", [](const std::vector<int>& ids) { return static_cast<int>(ids.size()); });
+
+  // each call converts 5000 elements
+  interp->eval(R"script(
+    @bench::ids = (1) x 5000;
+    sub bench::call_get_ids { my @ids = bench::get_ids(); }
+    sub bench::call_get_ids_ref { my $ids = bench::get_ids_ref(); }
+    sub bench::call_get_ids_array { my $ids = bench::get_ids_array(); }
+    sub bench::call_count_ids { bench::count_ids(\@bench::ids); }
+  )script");
+
+  BENCHMARK("vector return (list)") { interp->call_sub<void>("bench::call_get_ids"); };
+  BENCHMARK("vector return (as_ref)") { interp->call_sub<void>("bench::call_get_ids_ref"); };
+  BENCHMARK("perlbind::array return (reference)") { interp->call_sub<void>("bench::call_get_ids_array"); };
+  BENCHMARK("vector argument") { interp->call_sub<void>("bench::call_count_ids"); };
+}
+
+TEST_CASE("context return policy latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_ids", &get_bench_ids);
+  package.add("get_ids_policy", &get_bench_ids, perlbind::return_policy::count);
+
+  // each call returns 5000 elements
+  interp->eval(R"script(
+    sub bench::call_get_ids_void { bench::get_ids(); 1; }
+    sub bench::call_get_ids_policy_void { bench::get_ids_policy(); 1; }
+    sub bench::call_get_ids_scalar { my $count = bench::get_ids(); }
+    sub bench::call_get_ids_policy_scalar { my $count = bench::get_ids_policy(); }
+  )script");
+
+  BENCHMARK("void context") { interp->call_sub<void>("bench::call_get_ids_void"); };
+  BENCHMARK("void context (count policy)") { interp->call_sub<void>("bench::call_get_ids_policy_void"); };
+  BENCHMARK("scalar context") { interp->call_sub<void>("bench::call_get_ids_scalar"); };
+  BENCHMARK("scalar context (count policy)") { interp->call_sub<void>("bench::call_get_ids_policy_scalar"); };
+}
+
+TEST_CASE("multiple return latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_loc", &get_bench_loc);
+  package.add("get_loc_hash", &get_bench_loc_hash);
+
+  interp->eval(R"script(
+    sub bench::call_get_loc { for (1..1000) { my ($x, $y, $z) = bench::get_loc(); } }
+    sub bench::call_get_loc_hash { for (1..1000) { my $loc = bench::get_loc_hash(); my ($x, $y, $z) = @$loc{qw(x y z)}; } }
+  )script");
+
+  BENCHMARK("tuple return") { interp->call_sub<void>("bench::call_get_loc"); };
+  BENCHMARK("hash reference return") { interp->call_sub<void>("bench::call_get_loc_hash"); };
+}
+
+TEST_CASE("borrowed argument latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("sum_owned", [](perlbind::reference ref) {
+    perlbind::array arr = ref;
+    int sum = 0;
+    for (const auto& item : arr)
+      sum += static_cast<int>(item);
+    return sum;
+  });
+  package.add("sum_borrowed", [](perlbind::array_ref arr) {
+    int sum = 0;
+    for (perlbind::scalar_ref item : arr)
+      sum += item.as<int>();
+    return sum;
+  });
+
+  interp->eval(R"script(
+    @bench::values = (1) x 100;
+    sub bench::call_sum_owned { for (1..1000) { bench::sum_owned(\@bench::values); } }
+    sub bench::call_sum_borrowed { for (1..1000) { bench::sum_borrowed(\@bench::values); } }
+  )script");
+
+  BENCHMARK("owned array reference") { interp->call_sub<void>("bench::call_sum_owned"); };
+  BENCHMARK("borrowed array_ref") { interp->call_sub<void>("bench::call_sum_borrowed"); };
+}
+
+TEST_CASE("variadic argument latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("log_array", [](const char* fmt, perlbind::array rest) { return static_cast<int>(rest.size()); });
+  package.add("log_args", [](const char* fmt, perlbind::args rest) { return static_cast<int>(rest.size()); });
+  package.add("opts_hash", [](perlbind::hash opts) { return static_cast<int>(opts.size()); });
+  package.add("opts_kwargs", [](perlbind::kwargs opts) { return static_cast<int>(opts.size()); });
+
+  interp->eval(R"script(
+    sub bench::call_log_array { for (1..1000) { bench::log_array("%s %d %s", "a", 1, "b"); } }
+    sub bench::call_log_args { for (1..1000) { bench::log_args("%s %d %s", "a", 1, "b"); } }
+    sub bench::call_opts_hash { for (1..1000) { bench::opts_hash(name => "a", level => 1); } }
+    sub bench::call_opts_kwargs { for (1..1000) { bench::opts_kwargs(name => "a", level => 1); } }
+  )script");
+
+  BENCHMARK("perlbind::array varargs") { interp->call_sub<void>("bench::call_log_array"); };
+  BENCHMARK("perlbind::args varargs") { interp->call_sub<void>("bench::call_log_args"); };
+  BENCHMARK("perlbind::hash varargs") { interp->call_sub<void>("bench::call_opts_hash"); };
+  BENCHMARK("perlbind::kwargs varargs") { interp->call_sub<void>("bench::call_opts_kwargs"); };
+}
+
+TEST_CASE("perl sub call latency", "[benchmark][.]")
+{
+  interp->eval("sub bench::event_say { return $_[0]; }");
+  auto handle = interp->get_sub("bench::event_say");
+
+  // 1000 calls from native code to match the other benchmarks
+  BENCHMARK("call_sub by name")
+  {
+    for (int i = 0; i < 1000; ++i)
+      interp->call_sub<int>("bench::event_say", i);
+  };
+  BENCHMARK("sub_handle call")
+  {
+    for (int i = 0; i < 1000; ++i)
+      handle.call<int>(i);
+  };
+}
+
+TEST_CASE("repeated perl sub call latency", "[benchmark][.]")
+{
+  interp->eval(R"script(
+    sub bench::score { return $_[0] * 2 + 1; }
+    sub bench::score_topic { return $_ * 2 + 1; }
+  )script");
+
+  auto handle = interp->get_sub("bench::score");
+  std::vector<int> npcs(5000, 1);
+
+  // each benchmark scores 5000 items
+  BENCHMARK("sub_handle call per item")
+  {
+    double total = 0;
+    for (int npc : npcs)
+      total += handle.call<double>(npc);
+    return total;
+  };
+  BENCHMARK("multicall ($_)")
+  {
+    double total = 0;
+    interp->multicall<double>("bench::score_topic", npcs, [&](int, double score) { total += score; });
+    return total;
+  };
+  BENCHMARK("multicall (@_)")
+  {
+    double total = 0;
+    interp->multicall<double>(handle, npcs, [&](int, double score) { total += score; }, perlbind::multicall_arg::args);
+    return total;
+  };
+}
+
+TEST_CASE("batched event dispatch latency", "[benchmark][.]")
+{
+  interp->eval("sub bench::event_zone { my ($name, $id) = @_; return; }");
+  auto handle = interp->get_sub("bench::event_zone");
+
+  // 1000 entity scripts receiving the same event
+  std::vector<std::pair<perlbind::sub_handle*, std::tuple<std::string, int>>> calls;
+  for (int i = 0; i < 1000; ++i)
+    calls.push_back({ &handle, std::make_tuple(std::string("zone"), i) });
+
+  BENCHMARK("sub_handle call per event")
+  {
+    for (const auto& call : calls)
+      handle.call<void>(std::get<0>(call.second), std::get<1>(call.second));
+  };
+  BENCHMARK("call_batch") { return interp->call_batch(calls).size(); };
+}
+
+TEST_CASE("eval latency", "[benchmark][.]")
+{
+  const char* code = R"script(
+    my %counts;
+    for my $word (qw(hail zone timer say)) { $counts{$word}++; }
+    $bench::eval_result = join(",", map { "$_=$counts{$_}" } sort keys %counts);
+  )script";
+
+  auto compiled = interp->compile(code);
+
+  BENCHMARK("eval") { interp->eval(code); };
+  BENCHMARK("compiled code") { compiled.call<void>(); };
+
+  interp->use_eval_cache();
+  BENCHMARK("eval (cached)") { interp->eval(code); };
+  interp->use_eval_cache(0);
+}
+
+TEST_CASE("perl sub return value latency", "[benchmark][.]")
+{
+  auto my_perl = interp->get();
+  interp->eval(R"script(
+    sub bench::event_global { $bench::result = "response $_[0]"; }
+    sub bench::event_return { return "response $_[0]"; }
+  )script");
+
+  auto global_handle = interp->get_sub("bench::event_global");
+  auto return_handle = interp->get_sub("bench::event_return");
+
+  BENCHMARK("string result through package global")
+  {
+    std::string result;
+    for (int i = 0; i < 1000; ++i)
+    {
+      global_handle.call<void>(i);
+      result = SvPV_nolen(get_sv("bench::result", 0));
+    }
+    return result;
+  };
+  BENCHMARK("string return value")
+  {
+    std::string result;
+    for (int i = 0; i < 1000; ++i)
+      result = return_handle.call<std::string>(i);
+    return result;
+  };
+}
+
+TEST_CASE("derived object call latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_merchant", &get_bench_merchant);
+
+  auto npc_class = interp->new_class<bench_npc>("bench_npc");
+  npc_class.add("get_level", &bench_npc::get_level);
+
+  auto merchant_class = interp->new_class<bench_merchant>("bench_merchant");
+  merchant_class.add_base_class("bench_npc");
+
+  interp->eval(R"script(
+    sub bench::call_derived_get_level { my $merchant = bench::get_merchant(); for (1..1000) { $merchant->get_level(); } }
+  )script");
+
+  BENCHMARK("inherited member getter") { interp->call_sub<void>("bench::call_derived_get_level"); };
+}
+
+TEST_CASE("object return latency", "[benchmark][.]")
+{
+  auto package = interp->new_package("bench");
+  package.add("get_npc", &get_bench_npc);
+  package.add("get_mapped_npc", &get_bench_mapped_npc);
+  package.add("make_pos", &make_bench_pos);
+  package.add("make_shared_pos", &make_shared_bench_pos);
+
+  interp->new_class<bench_npc>("bench_npc");
+  interp->new_class<bench_mapped_npc>("bench_mapped_npc").use_identity_map();
+  interp->new_class<bench_pos>("bench_pos");
+
+  interp->eval(R"script(
+    sub bench::call_get_npc { for (1..1000) { my $npc = bench::get_npc(); } }
+    sub bench::call_get_mapped_npc { my $keep = bench::get_mapped_npc(); for (1..1000) { my $npc = bench::get_mapped_npc(); } }
+    sub bench::call_make_pos { for (1..1000) { my $pos = bench::make_pos(); } }
+    sub bench::call_make_shared_pos { for (1..1000) { my $pos = bench::make_shared_pos(); } }
+  )script");
+
+  BENCHMARK("object return") { interp->call_sub<void>("bench::call_get_npc"); };
+  BENCHMARK("object return (identity map)") { interp->call_sub<void>("bench::call_get_mapped_npc"); };
+  BENCHMARK("object return by value") { interp->call_sub<void>("bench::call_make_pos"); };
+  BENCHMARK("object return (shared_ptr)") { interp->call_sub<void>("bench::call_make_shared_pos"); };
+}
@@ -95,6 +95,310 @@ TEST_CASE("base class inheritance", "[package]")
   REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 40));
 }
 
+TEST_CASE("base class checks follow runtime isa changes", "[package]")
+{
+  struct isa_base {};
+  struct isa_middle {};
+  struct isa_derived
+  {
+    static isa_derived* getinst() { static isa_derived inst; return &inst; }
+    static int is_base(isa_base* self) { return self != nullptr; }
+  };
+
+  auto my_perl = interp->get();
+  interp->new_class<isa_base>("isa_base");
+  interp->new_class<isa_middle>("isa_middle");
+  auto package = interp->new_class<isa_derived>("isa_derived");
+  package.add("getinst", &isa_derived::getinst);
+  package.add("is_base", &isa_derived::is_base);
+
+  REQUIRE_NOTHROW(interp->eval("$isa_obj = isa_derived::getinst();"));
+  REQUIRE_THROWS(interp->eval("isa_derived::is_base($isa_obj);"));
+
+  package.add_base_class("isa_middle");
+  REQUIRE_THROWS(interp->eval("isa_derived::is_base($isa_obj);"));
+
+  // grandparent added from perl
+  REQUIRE_NOTHROW(interp->eval("push @isa_middle::ISA, 'isa_base';"));
+  REQUIRE_NOTHROW(interp->eval("$result = isa_derived::is_base($isa_obj);"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 1));
+  REQUIRE_NOTHROW(interp->eval("$result = isa_derived::is_base($isa_obj);")); // cached
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 1));
+
+  REQUIRE_NOTHROW(interp->eval("@isa_middle::ISA = ();"));
+  REQUIRE_THROWS(interp->eval("isa_derived::is_base($isa_obj);"));
+}
+
+TEST_CASE("typed object handles", "[package][typemap]")
+{
+  struct handle_base
+  {
+    static int get_id(handle_base* self) { return self->m_id; }
+    int m_id = 7;
+  };
+  struct handle_derived : handle_base
+  {
+    static handle_derived* getinst() { static handle_derived inst; return &inst; }
+  };
+
+  auto my_perl = interp->get();
+  auto base = interp->new_class<handle_base>("handle_base");
+  base.use_typed_handles();
+  base.add("get_id", &handle_base::get_id);
+
+  auto derived = interp->new_class<handle_derived>("handle_derived");
+  derived.use_typed_handles();
+  derived.add_base_class("handle_base");
+  derived.add("getinst", &handle_derived::getinst);
+
+  REQUIRE_NOTHROW(interp->eval("$handle = handle_derived::getinst();"));
+  SV* obj = SvRV(get_sv("handle", 0));
+  const MAGIC* mg = perlbind::detail::handle::find(my_perl, obj);
+  REQUIRE(mg != nullptr);
+  REQUIRE(perlbind::detail::handle::get_ptr(mg) == handle_derived::getinst());
+  REQUIRE(perlbind::detail::handle::get_type_id(mg) == perlbind::detail::usertype<handle_derived*>::id());
+
+  REQUIRE_NOTHROW(interp->eval("$result = $handle->get_id();"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 7));
+
+  SECTION("forged objects are rejected")
+  {
+    REQUIRE_NOTHROW(interp->eval("$forged = bless \\(my $x = $$handle), 'handle_derived';"));
+    REQUIRE_THROWS(interp->eval("$forged->get_id();"));
+  }
+
+  SECTION("scalar conversions")
+  {
+    perlbind::scalar value = handle_derived::getinst();
+    REQUIRE(perlbind::detail::handle::find(my_perl, SvRV(static_cast<SV*>(value))) != nullptr);
+    REQUIRE(value.as<handle_derived*>() == handle_derived::getinst());
+    REQUIRE(value.as<handle_base*>() == handle_derived::getinst());
+  }
+}
+
+TEST_CASE("identity mapped objects", "[package][typemap]")
+{
+  struct mapped
+  {
+    static mapped* get(int index) { static mapped inst[2]; return &inst[index]; }
+    static int get_index(mapped* self) { return self == get(1) ? 1 : 0; }
+  };
+
+  auto my_perl = interp->get();
+  auto package = interp->new_class<mapped>("mapped");
+  package.use_typed_handles();
+  package.use_identity_map();
+  package.add("get", &mapped::get);
+  package.add("get_index", &mapped::get_index);
+
+  REQUIRE_NOTHROW(interp->eval("$mapped1 = mapped::get(0); $mapped2 = mapped::get(0); $mapped3 = mapped::get(1);"));
+  REQUIRE_NOTHROW(interp->eval("$result = ($mapped1 == $mapped2 && $mapped1 != $mapped3) ? 1 : 0;"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 1));
+
+  SECTION("freed objects are recreated")
+  {
+    REQUIRE_NOTHROW(interp->eval("undef $mapped1; undef $mapped2; $mapped1 = mapped::get(0);"));
+    REQUIRE_NOTHROW(interp->eval("$result = mapped::get_index($mapped1);"));
+    REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 0));
+  }
+
+  SECTION("invalidated objects are unusable")
+  {
+    REQUIRE(interp->invalidate_object(mapped::get(1)));
+    REQUIRE(!interp->invalidate_object(mapped::get(1)));
+    REQUIRE_THROWS(interp->eval("mapped::get_index($mapped3);"));
+
+    REQUIRE_NOTHROW(interp->eval("$mapped4 = mapped::get(1);"));
+    REQUIRE_NOTHROW(interp->eval("$result = ($mapped3 != $mapped4) ? mapped::get_index($mapped4) : 0;"));
+    REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 1));
+  }
+
+  REQUIRE_NOTHROW(interp->eval("undef $mapped1; undef $mapped2; undef $mapped3; undef $mapped4;"));
+}
+
+TEST_CASE("null object pointer returns", "[package][typemap]")
+{
+  struct nullret
+  {
+    static nullret* get_null() { return nullptr; }
+  };
+
+  auto my_perl = interp->get();
+  auto package = interp->new_class<nullret>("nullret");
+  package.use_identity_map();
+  package.add("get_null", &nullret::get_null);
+
+  std::size_t mapped = perlbind::detail::identity_map::get(my_perl).size();
+  REQUIRE_NOTHROW(interp->eval("$result = defined(nullret::get_null()) ? 1 : 0;"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 0));
+  REQUIRE(perlbind::detail::identity_map::get(my_perl).size() == mapped);
+}
+
+TEST_CASE("objects of deleted packages", "[package][typemap]")
+{
+  struct deleted
+  {
+    static deleted* getinst() { static deleted inst; return &inst; }
+  };
+
+  auto my_perl = interp->get();
+  interp->new_class<deleted>("deleted_package");
+  HV* stash = perlbind::detail::typemap::get_stash<deleted*>(my_perl);
+
+  ENTER;
+  SAVETMPS;
+  hv_delete(PL_defstash, "deleted_package::", 17, G_DISCARD);
+  FREETMPS; // deleted glob is mortal
+  LEAVE;
+  REQUIRE(SvTYPE(stash) == SVt_PVHV); // not freed
+  perlbind::scalar value = deleted::getinst();
+  REQUIRE(sv_isobject(value));
+  REQUIRE(SvSTASH(SvRV(static_cast<SV*>(value))) == stash);
+  REQUIRE(value.as<deleted*>() == deleted::getinst());
+}
+
+TEST_CASE("invalidated objects without typed handles", "[package][typemap]")
+{
+  struct untyped
+  {
+    static untyped* getinst() { static untyped inst; return &inst; }
+    int get_id() { return m_id; }
+    int m_id = 5;
+  };
+
+  auto my_perl = interp->get();
+  auto package = interp->new_class<untyped>("untyped_mapped");
+  package.use_identity_map();
+  package.add("getinst", &untyped::getinst);
+  package.add("get_id", &untyped::get_id);
+
+  REQUIRE_NOTHROW(interp->eval("$untyped = untyped_mapped::getinst(); $result = $untyped->get_id();"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 5));
+
+  REQUIRE(interp->invalidate_object(untyped::getinst()));
+  REQUIRE_THROWS(interp->eval("$untyped->get_id();"));
+
+  REQUIRE_NOTHROW(interp->eval("undef $untyped;"));
+}
+
+struct held
+{
+  held(int value) : m_value(value) { ++alive; }
+  ~held() { --alive; }
+  static int alive;
+  int m_value;
+};
+int held::alive = 0;
+
+struct held_api
+{
+  static std::shared_ptr<held> make_shared(int value) { return std::make_shared<held>(value); }
+  static std::unique_ptr<held> make_unique(int value) { return std::make_unique<held>(value); }
+  static held* get_raw() { static held inst(3); return &inst; }
+  static int get_value(const held& self) { return self.m_value; }
+  static void set_value(held& self, int value) { self.m_value = value; }
+  static long use_count(std::shared_ptr<held> self) { return self.use_count(); }
+  static std::shared_ptr<held> keep(std::shared_ptr<held> self) { s_kept = self; return self; }
+  static std::shared_ptr<held> s_kept;
+};
+
+std::shared_ptr<held> held_api::s_kept;
+
+TEST_CASE("smart pointer object holders", "[package][typemap]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_class<held>("held");
+  package.add("make_shared", &held_api::make_shared);
+  package.add("make_unique", &held_api::make_unique);
+  package.add("get_raw", &held_api::get_raw);
+  package.add("get_value", &held_api::get_value);
+  package.add("set_value", &held_api::set_value);
+  package.add("use_count", &held_api::use_count);
+  package.add("keep", &held_api::keep);
+
+  int alive = held::alive;
+
+  SECTION("objects are released when freed by perl")
+  {
+    REQUIRE_NOTHROW(interp->eval("$held1 = held::make_shared(1); $held2 = held::make_unique(2); 1;"));
+    REQUIRE(held::alive == alive + 2);
+
+    REQUIRE_NOTHROW(interp->eval("$held1->set_value(10); $result = $held1->get_value() + $held2->get_value();"));
+    REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 12));
+
+    REQUIRE_NOTHROW(interp->eval("undef $held1;"));
+    REQUIRE(held::alive == alive + 1);
+    REQUIRE_NOTHROW(interp->eval("undef $held2;"));
+    REQUIRE(held::alive == alive);
+  }
+
+  SECTION("shared ownership with native code")
+  {
+    REQUIRE_NOTHROW(interp->eval("$held1 = held::make_shared(1); $result = $held1->use_count();"));
+    REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 2)); // held by perl and argument
+
+    REQUIRE_NOTHROW(interp->eval("held::keep($held1); undef $held1;"));
+    REQUIRE(held::alive == alive + 1);
+    REQUIRE(held_api::s_kept->m_value == 1);
+    held_api::s_kept.reset();
+    REQUIRE(held::alive == alive);
+  }
+
+  SECTION("objects not owned by perl are not shared")
+  {
+    REQUIRE_NOTHROW(interp->eval("$held1 = held::get_raw(); $result = $held1->get_value();"));
+    REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 3));
+    REQUIRE_THROWS(interp->eval("$held1->use_count();"));
+    REQUIRE_NOTHROW(interp->eval("undef $held1;"));
+  }
+}
+
+struct position
+{
+  position(float x, float y) : x(x), y(y) { ++alive; }
+  position(const position& other) : x(other.x), y(other.y) { ++alive; }
+  ~position() { --alive; }
+  static position make(float x, float y) { return position(x, y); }
+  static float get_x(const position& self) { return self.x; }
+  static float get_y(position* self) { return self->y; }
+  static position add(position a, position b) { return position(a.x + b.x, a.y + b.y); }
+  static int alive;
+  float x;
+  float y;
+};
+int position::alive = 0;
+
+namespace perlbind {
+template <> struct by_value<position> : std::true_type {};
+}
+
+TEST_CASE("objects returned by value", "[package][typemap]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_class<position>("position");
+  package.add("make", &position::make);
+  package.add("get_x", &position::get_x);
+  package.add("get_y", &position::get_y);
+  package.add("add", &position::add);
+
+  int alive = position::alive;
+  REQUIRE_NOTHROW(interp->eval("$pos1 = position::make(1.5, 2.5); $pos2 = position::make(3.5, 4.5); 1;"));
+  REQUIRE(position::alive == alive + 2);
+
+  SV* obj = SvRV(get_sv("pos1", 0));
+  const MAGIC* mg = perlbind::detail::handle::find(my_perl, obj);
+  REQUIRE(mg != nullptr);
+  REQUIRE(perlbind::detail::handle::is_value(mg));
+  REQUIRE(perlbind::detail::handle::get_type_id(mg) == perlbind::detail::usertype<position*>::id());
+
+  REQUIRE_NOTHROW(interp->eval("$pos3 = position::add($pos1, $pos2); $result = $pos3->get_x() + $pos3->get_y(); 1;"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvNV(get_sv("result", 0)) == 12.0));
+  REQUIRE(position::alive == alive + 3);
+
+  REQUIRE_NOTHROW(interp->eval("undef $pos1; undef $pos2; undef $pos3;"));
+  REQUIRE(position::alive == alive);
+}
+
 TEST_CASE("constants", "[package][function]")
 {
   auto my_perl = interp->get();
@@ -215,14 +519,330 @@ TEST_CASE("overload priority with array parameter", "[package][function]")
   }
 }
 
+struct overload_obj_a {};
+struct overload_obj_b {};
+overload_obj_a g_overload_obj_a;
+overload_obj_b g_overload_obj_b;
+TEST_CASE("overloads with object and mixed arity parameters", "[package][function]")
+{
+  struct foo
+  {
+    static overload_obj_a* get_a() { return &g_overload_obj_a; }
+    static overload_obj_b* get_b() { return &g_overload_obj_b; }
+    static int bar(overload_obj_a* p1) { return 1; }
+    static int bar(overload_obj_b* p1) { return 2; }
+    static int bar(overload_obj_b* p1, int p2) { return 3; }
+    static int bar(const char* p1, int p2, int p3) { return 4; }
+  };
+
+  auto my_perl = interp->get();
+  interp->new_class<overload_obj_a>("overload_obj_a");
+  interp->new_class<overload_obj_b>("overload_obj_b");
+
+  auto package = interp->new_package("foo");
+  package.add("get_overload_a", &foo::get_a);
+  package.add("get_overload_b", &foo::get_b);
+  package.add("objbar", (int(*)(overload_obj_a*))&foo::bar);
+  package.add("objbar", (int(*)(overload_obj_b*))&foo::bar);
+  package.add("objbar", (int(*)(overload_obj_b*, int))&foo::bar);
+  package.add("objbar", (int(*)(const char*, int, int))&foo::bar);
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $a = foo::get_overload_a();
+    $b = foo::get_overload_b();
+    $result1 = foo::objbar($a);
+    $result2 = foo::objbar($b);
+    $result3 = foo::objbar($b, 10);
+    $result4 = foo::objbar("str", 10, 20);
+  )script"));
+
+  REQUIRE((get_sv("result1", 0) != nullptr && SvIV(get_sv("result1", 0)) == 1));
+  REQUIRE((get_sv("result2", 0) != nullptr && SvIV(get_sv("result2", 0)) == 2));
+  REQUIRE((get_sv("result3", 0) != nullptr && SvIV(get_sv("result3", 0)) == 3));
+  REQUIRE((get_sv("result4", 0) != nullptr && SvIV(get_sv("result4", 0)) == 4));
+  REQUIRE_THROWS(interp->eval("foo::objbar($a, 10);"));
+  REQUIRE_THROWS(interp->eval("foo::objbar(1, 2, 3, 4);"));
+}
+
+TEST_CASE("overload resolution with repeated argument kinds", "[package][function]")
+{
+  struct foo
+  {
+    static int bar(const char* p1) { return 1; }
+    static int bar(perlbind::reference p1) { return 2; }
+    static int bar(int p1, int p2) { return 3; }
+    static int bar(perlbind::array p1) { return 4; }
+  };
+
+  auto package = interp->new_package("foo");
+  package.add("cachebar", (int(*)(perlbind::reference))&foo::bar);
+  package.add("cachebar", (int(*)(const char*))&foo::bar);
+
+  interp->eval(R"script(
+    sub cachebar_sum { my $sum = 0; $sum += foo::cachebar(@_) for (1..3); return $sum; }
+  )script");
+
+  REQUIRE(interp->call_sub<int>("cachebar_sum", "str") == 3);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", perlbind::reference(perlbind::array())) == 6);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", "str") == 3);
+  REQUIRE_THROWS(interp->call_sub<int>("cachebar_sum", 1, 2));
+
+  // adding an overload invalidates previously resolved calls
+  package.add("cachebar", (int(*)(int, int))&foo::bar);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", 1, 2) == 9);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", "str") == 3);
+
+  package.add("cachebar", (int(*)(perlbind::array))&foo::bar);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", 1, 2, 3) == 12);
+  REQUIRE(interp->call_sub<int>("cachebar_sum", 1, 2) == 9);
+}
+
+TEST_CASE("single function subs use a direct xsub entry", "[package][function]")
+{
+  struct foo
+  {
+    static int bar(int p1) { return p1; }
+    static int bar(const char* p1) { return 2; }
+  };
+
+  using direct_t = perlbind::detail::function<int(*)(int)>;
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("foo");
+  package.add("directbar", (int(*)(int))&foo::bar);
+
+  CV* cv = get_cv("foo::directbar", 0);
+  REQUIRE(CvXSUB(cv) == &direct_t::xsub);
+  REQUIRE_NOTHROW(interp->eval("$result1 = foo::directbar(10);"));
+  REQUIRE_THROWS(interp->eval("foo::directbar();"));
+
+  // adding an overload falls back to the overload dispatcher
+  package.add("directbar", (int(*)(const char*))&foo::bar);
+  REQUIRE(CvXSUB(cv) != &direct_t::xsub);
+  REQUIRE_NOTHROW(interp->eval("$result2 = foo::directbar(20);"));
+  REQUIRE_NOTHROW(interp->eval("$result3 = foo::directbar('str');"));
+
+  REQUIRE((get_sv("result1", 0) != nullptr && SvIV(get_sv("result1", 0)) == 10));
+  REQUIRE((get_sv("result2", 0) != nullptr && SvIV(get_sv("result2", 0)) == 20));
+#ifndef PERLBIND_NO_STRICT_SCALAR_TYPES
+  REQUIRE((get_sv("result3", 0) != nullptr && SvIV(get_sv("result3", 0)) == 2));
+#endif
+}
+
+struct boundclass
+{
+  static boundclass* get_bound();
+  static int static_bound(int a, int b) { return a + b; }
+  int get_level() const { return m_level; }
+  int get_level(int add) { return m_level + add; }
+  int m_level = 50;
+};
+boundclass g_boundclass;
+boundclass* boundclass::get_bound() { return &g_boundclass; }
+TEST_CASE("compile time bound function bindings", "[package][function]")
+{
+  using const_level_t = int(boundclass::*)() const;
+  using level_t = int(boundclass::*)(int);
+
+  auto my_perl = interp->get();
+  auto package = interp->new_class<boundclass>("boundclass");
+  package.add<decltype(&boundclass::get_bound), &boundclass::get_bound>("get_bound");
+  package.add<decltype(&boundclass::static_bound), &boundclass::static_bound>("static_bound");
+  package.add<const_level_t, &boundclass::get_level>("get_level");
+  package.add<level_t, &boundclass::get_level>("get_level");
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $bound = boundclass::get_bound();
+    $result1 = boundclass::static_bound(10, 20);
+    $result2 = $bound->get_level();
+    $result3 = $bound->get_level(5);
+  )script"));
+
+  REQUIRE((get_sv("result1", 0) != nullptr && SvIV(get_sv("result1", 0)) == 30));
+  REQUIRE((get_sv("result2", 0) != nullptr && SvIV(get_sv("result2", 0)) == 50));
+  REQUIRE((get_sv("result3", 0) != nullptr && SvIV(get_sv("result3", 0)) == 55));
+  REQUIRE_THROWS(interp->eval("boundclass::static_bound(10);"));
+
+#ifdef __cpp_nontype_template_parameter_auto
+  package.add<&boundclass::static_bound>("static_bound17");
+  REQUIRE_NOTHROW(interp->eval("$result4 = boundclass::static_bound17(1, 2);"));
+  REQUIRE((get_sv("result4", 0) != nullptr && SvIV(get_sv("result4", 0)) == 3));
+#endif
+}
+
 TEST_CASE("typemap ids in another translation unit", "[interpreter][typemap]")
 {
   // typemap ids created in interpreter.cpp main() should be the same here
+  REQUIRE(perlbind::detail::usertype<bool>::id() == 2);
+  REQUIRE(perlbind::detail::usertype<double>::id() == 1);
+  REQUIRE(perlbind::detail::usertype<int>::id() == 0);
+}
+
+TEST_CASE("scalar returns use the calling op's target", "[function]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("targ");
+  package.add("tmps_ix", [my_perl]() -> int { return static_cast<int>(PL_tmps_ix); });
+  package.add("get_int", [](int value) { return value; });
+  package.add("get_str", [](std::string value) { return value; });
+
+  // no mortals are created for the returned values
+  REQUIRE_NOTHROW(interp->eval("@tmps = (targ::tmps_ix(), targ::get_int(5), targ::get_str('a'), targ::tmps_ix()); $result = $tmps[3] - $tmps[0];"));
+  REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 0));
+
+  // targets are copied when results from the same op are collected
+  REQUIRE_NOTHROW(interp->eval("$result = join(',', map { targ::get_int($_) } 1..3);"));
+  REQUIRE((get_sv("result", 0) != nullptr && strcmp(SvPV_nolen(get_sv("result", 0)), "1,2,3") == 0));
+  REQUIRE_NOTHROW(interp->eval("@strs = map { targ::get_str($_) } qw(a b c); $result = join(',', @strs);"));
+  REQUIRE((get_sv("result", 0) != nullptr && strcmp(SvPV_nolen(get_sv("result", 0)), "a,b,c") == 0));
+}
+
+TEST_CASE("multiple return values", "[function]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("multi");
+  package.add("pos", []() { return std::make_tuple(1, 2.5, std::string("three")); });
+  package.add("pair", []() { return std::make_pair(std::string("id"), std::vector<int>{ 4, 5 }); });
+  package.add("none", []() { return std::tuple<>(); });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    ($x, $y, $z) = multi::pos();
+    $count = () = multi::pos();
+    $last = multi::pos();
+    ($name, $ids) = multi::pair();
+    $last_ids = multi::pair();
+    @none = multi::none();
+    $none = multi::none();
+    $result = join(',', $x, $y, $z, $count, $last, $name, @$ids, scalar(@$last_ids), scalar(@none), defined($none) ? 1 : 0);
+  )script"));
+
+  REQUIRE(strcmp(SvPV_nolen(get_sv("result", 0)), "1,2.5,three,3,three,id,4,5,2,0,0") == 0);
+}
+
+struct counted
+{
+  counted() = default;
+  counted(const counted&) { ++conversions; }
+  static int conversions;
+};
+int counted::conversions = 0;
+
+namespace perlbind {
+template <> struct by_value<counted> : std::true_type {};
+}
+
+TEST_CASE("context aware return policies", "[function]")
+{
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("policy");
+  interp->new_class<counted>("counted");
+  auto ids = []() { return std::vector<int>{ 4, 5, 6 }; };
+  package.add("ids", ids);
+  package.add("ids_count", ids, perlbind::return_policy::count);
+  package.add("ids_ref", ids, perlbind::return_policy::reference);
+  package.add("map_ref", []() { return std::map<std::string, int>{ { "a", 1 } }; }, perlbind::return_policy::reference);
+  package.add("tuple_count", []() { return std::make_tuple(1, 2); }, perlbind::return_policy::count);
+  package.add("get_value", []() { return 7; }, perlbind::return_policy::count);
+  package.add("get_counted", []() { return std::vector<counted>(2); }, perlbind::return_policy::skip_void);
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $last = policy::ids();
+    $count = policy::ids_count();
+    @list = policy::ids_count();
+    $ref = policy::ids_ref();
+    @ref_list = policy::ids_ref();
+    $map_ref = policy::map_ref();
+    $tuple_count = policy::tuple_count();
+    $value = policy::get_value();
+    $result = join(',', $last, $count, scalar(@list), ref($ref), scalar(@$ref), scalar(@ref_list), $map_ref->{a}, $tuple_count, $value);
+  )script"));
+  REQUIRE(strcmp(SvPV_nolen(get_sv("result", 0)), "6,3,3,ARRAY,3,3,1,2,7") == 0);
+
+  // elements aren't converted in void context
+  counted::conversions = 0;
+  REQUIRE_NOTHROW(interp->eval("policy::get_counted(); 1;"));
+  REQUIRE(counted::conversions == 0);
+  REQUIRE_NOTHROW(interp->eval("@objs = policy::get_counted(); 1;"));
+  REQUIRE(counted::conversions == 2);
+}
+
+TEST_CASE("interned string returns", "[function]")
+{
+  static const std::string long_name(2000, 'x');
+  static const std::string long_copy(2000, 'x'); // distinct native string, same text
+  static const std::string short_name = "zone";
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("interned");
+  package.add("long_name", []() -> const std::string& { return long_name; });
+  package.add("long_copy", []() -> const std::string& { return long_copy; });
+  package.add("short_name", []() -> const std::string& { return short_name; });
+  package.add("by_value", []() { return std::string("value"); });
+
+  auto& cache = perlbind::detail::string_cache::get(my_perl);
+  interp->use_string_interning();
+
+  REQUIRE_NOTHROW(interp->eval("$a = interned::long_name(); $b = interned::long_copy(); $c = interned::short_name() for 1..3; $d = interned::by_value();"));
+  REQUIRE(cache.size() == 2); // by value returns aren't interned
+
+  SV* a = get_sv("a", 0);
+  SV* b = get_sv("b", 0);
+  REQUIRE(SvCUR(a) == 2000);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("c", 0)), "zone") == 0);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("d", 0)), "value") == 0);
+#ifdef PERLBIND_COW_FLAGS
+  REQUIRE(SvIsCOW(a));
+  REQUIRE(SvPVX(a) == SvPVX(b)); // both share the interned buffer
+#endif
+
+  // modifying a returned string doesn't affect the interned string
+  REQUIRE_NOTHROW(interp->eval("$a .= 'y'; $e = interned::long_name();"));
+  REQUIRE(SvCUR(get_sv("a", 0)) == 2001);
+  REQUIRE(SvCUR(get_sv("e", 0)) == 2000);
+
+  interp->use_string_interning(false);
+  REQUIRE(cache.size() == 0);
+  REQUIRE_NOTHROW(interp->eval("$a = interned::long_name();"));
+  REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("interned string eviction", "[function]")
+{
+  using cache_t = perlbind::detail::string_cache;
+  const std::size_t max_size = cache_t::max_size;
+  static std::vector<std::string> names;
+  static const std::string hot_name = "hot";
+  for (std::size_t i = 0; i < max_size * 2; ++i)
+    names.push_back("name" + std::to_string(i));
+
   auto my_perl = interp->get();
-  auto typemap = perlbind::detail::typemap::get(my_perl);
-  REQUIRE(perlbind::detail::usertype<bool>::id() == "2");
-  REQUIRE(perlbind::detail::usertype<double>::id() == "1");
-  REQUIRE(perlbind::detail::usertype<int>::id() == "0");
+  auto package = interp->new_package("evicted");
+  package.add("name", [](int i) -> const std::string& { return names[i]; });
+  package.add("hot_name", []() -> const std::string& { return hot_name; });
+
+  auto& cache = cache_t::get(my_perl);
+  interp->use_string_interning();
+
+  SV* hot = cache.intern(hot_name);
+  REQUIRE_NOTHROW(interp->eval(R"(
+    @evicted::names = map { my $hot = evicted::hot_name(); evicted::name($_) } 0..8191;
+    $evicted::last = evicted::name(0);
+  )"));
+
+  REQUIRE(cache.size() == max_size);
+  REQUIRE(cache.intern(hot_name) == hot); // returned on every pass so never evicted
+  REQUIRE(cache.intern(names.back()) != nullptr); // interned after the cache filled
+
+  // evicted strings returned earlier in the statement are still valid
+  AV* av = get_av("evicted::names", 0);
+  REQUIRE(static_cast<std::size_t>(av_len(av) + 1) == max_size * 2);
+  for (SSize_t i = 0; i <= av_len(av); i += 1000)
+    REQUIRE(names[i] == SvPV_nolen(*av_fetch(av, i, 0)));
+  REQUIRE(strcmp(SvPV_nolen(get_sv("evicted::last", 0)), "name0") == 0);
+
+  interp->use_string_interning(false);
+  REQUIRE(cache.size() == 0);
 }
 
 TEST_CASE("exception in function binding call", "[function]")
@@ -238,7 +858,7 @@ TEST_CASE("exception in function binding call", "[function]")
   REQUIRE_THROWS(interp->eval("foo::catchbar(1);"));
 }
 
-TEST_CASE("overload array should not leak after xsub croak", "[package][function]")
+TEST_CASE("overload set should not leak after xsub croak", "[package][function]")
 {
   struct overloads
   {
@@ -257,16 +877,18 @@ TEST_CASE("overload array should not leak after xsub croak", "[package][function
     sub nocroaksub { overloads::foo(1,1,1); }
   )script");
 
-  AV* av = GvAV(CvGV(get_cv("overloads::foo", 0)));
-  REQUIRE(SvREFCNT(av) == 1);
+  // overloads are stored natively on the CV instead of in a perl array
+  CV* cv = get_cv("overloads::foo", 0);
+  REQUIRE(GvAV(CvGV(cv)) == nullptr);
+  REQUIRE(SvREFCNT(cv) == 1);
 
   // no overload found
   REQUIRE_THROWS(interp->call_sub<int>("croaksub"));
-  REQUIRE(SvREFCNT(av) == 1);
+  REQUIRE(SvREFCNT(cv) == 1);
   // overload found but throws in call
   REQUIRE_THROWS(interp->call_sub<int>("throwsub"));
-  REQUIRE(SvREFCNT(av) == 1);
+  REQUIRE(SvREFCNT(cv) == 1);
   // overload found and doesn't croak
   REQUIRE_NOTHROW(interp->call_sub<int>("nocroaksub"));
-  REQUIRE(SvREFCNT(av) == 1);
+  REQUIRE(SvREFCNT(cv) == 1);
 }
@@ -4,7 +4,11 @@
 #include <perlbind/perlbind.h>
 
 #include <fstream>
+#include <map>
 #include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
 
 // interpreter for all tests (can only create once per program due to PERL_SYS_INIT3/PERL_SYS_TERM)
 std::unique_ptr<perlbind::interpreter> interp;
@@ -73,6 +77,348 @@ TEST_CASE("calling perl subs", "[subcaller]")
   REQUIRE_THROWS(interp->call_sub<int>("callpackage::throwsub"));
 }
 
+TEST_CASE("calling perl subs with return types", "[subcaller]")
+{
+  struct returned_object { int id = 7; };
+  interp->new_class<returned_object>("returned_object");
+
+  interp->eval(R"script(
+    package returnpackage;
+    sub get_string { return "name\0" . $_[0]; }
+    sub get_float { return 2.5; }
+    sub get_undef { return undef; }
+    sub get_number { return 42; }
+    sub get_sparse { return (1, undef, '3'); }
+    sub get_list { return (1, 2, 3); }
+    sub get_empty { return; }
+    sub get_pairs { return (a => 1, b => 2); }
+    sub get_mixed { return (5, "five", 5.5); }
+    sub get_ref { return [1, 2]; }
+    sub get_object { return $_[0]; }
+    sub get_context { return wantarray ? "list" : "scalar"; }
+    sub throwsub { die "should throw"; }
+  )script");
+
+  std::string str = interp->call_sub<std::string>("returnpackage::get_string", "x");
+  REQUIRE(str == std::string("name\0x", 6));
+  REQUIRE(interp->call_sub<double>("returnpackage::get_float") == 2.5);
+  REQUIRE(interp->call_sub<int>("returnpackage::get_undef") == 0);
+  REQUIRE(interp->call_sub<bool>("returnpackage::get_float"));
+  REQUIRE(interp->call_sub<std::string>("returnpackage::get_context") == "scalar");
+  REQUIRE(interp->call_sub<std::string>("returnpackage::get_number") == "42");
+  REQUIRE(interp->call_sub<std::string>("returnpackage::get_empty").empty());
+
+  auto list = interp->call_sub<std::vector<int>>("returnpackage::get_list");
+  REQUIRE(list == std::vector<int>{ 1, 2, 3 });
+  REQUIRE(interp->call_sub<std::vector<std::string>>("returnpackage::get_context") == std::vector<std::string>{ "list" });
+  REQUIRE(interp->call_sub<std::vector<int>>("returnpackage::get_empty").empty());
+  REQUIRE(interp->call_sub<std::array<int, 3>>("returnpackage::get_list")[2] == 3);
+  REQUIRE(interp->call_sub<std::vector<int>>("returnpackage::get_sparse") == std::vector<int>{ 1, 0, 3 });
+  REQUIRE(interp->call_sub<std::vector<std::string>>("returnpackage::get_list") == std::vector<std::string>{ "1", "2", "3" });
+
+  auto mixed = interp->call_sub<std::tuple<int, std::string, double>>("returnpackage::get_mixed");
+  REQUIRE(mixed == std::make_tuple(5, std::string("five"), 5.5));
+
+  auto pairs = interp->call_sub<std::map<std::string, int>>("returnpackage::get_pairs");
+  REQUIRE(pairs == std::map<std::string, int>{ { "a", 1 }, { "b", 2 } });
+
+  perlbind::array arr = interp->call_sub<perlbind::array>("returnpackage::get_list");
+  REQUIRE(arr.size() == 3);
+  perlbind::hash hash = interp->call_sub<perlbind::hash>("returnpackage::get_pairs");
+  REQUIRE(hash.size() == 2);
+  REQUIRE(interp->call_sub<perlbind::array>("returnpackage::get_empty").size() == 0);
+
+  perlbind::reference ref = interp->call_sub<perlbind::reference>("returnpackage::get_ref");
+  REQUIRE(ref.is_array_ref());
+  REQUIRE(SvREFCNT(ref.sv()) == 1); // the returned value is held, not copied
+  REQUIRE(interp->call_sub<perlbind::scalar>("returnpackage::get_float").as<double>() == 2.5);
+  REQUIRE(interp->call_sub<std::tuple<std::vector<int>>>("returnpackage::get_ref") == std::make_tuple(std::vector<int>{ 1, 2 }));
+
+  returned_object obj;
+  REQUIRE(interp->call_sub<returned_object*>("returnpackage::get_object", &obj) == &obj);
+
+  auto handle = interp->get_sub("returnpackage::get_list");
+  REQUIRE(handle.call<std::vector<int>>().size() == 3);
+
+  // stack is left balanced by failed calls and conversions
+  auto my_perl = interp->get();
+  SV** sp = PL_stack_sp;
+  REQUIRE_THROWS(interp->call_sub<std::string>("returnpackage::throwsub"));
+  REQUIRE_THROWS(interp->call_sub<std::vector<int>>("returnpackage::throwsub"));
+  REQUIRE_THROWS(interp->call_sub<std::tuple<int, int>>("returnpackage::get_list"));
+  REQUIRE_THROWS(interp->call_sub<std::vector<returned_object*>>("returnpackage::get_mixed"));
+  REQUIRE_THROWS(interp->call_sub<returned_object*>("returnpackage::get_float"));
+  REQUIRE(PL_stack_sp == sp);
+}
+
+TEST_CASE("calling perl subs through handles", "[subcaller]")
+{
+  auto handle = interp->get_sub("handlepackage::testsub");
+  REQUIRE(handle.name() == "handlepackage::testsub");
+  REQUIRE(!handle.exists());
+  REQUIRE_THROWS(handle.call<int>());
+
+  interp->eval("package handlepackage; sub testsub { return 5 + ($_[0] // 0); }");
+  REQUIRE(handle.exists());
+  REQUIRE(handle.call<int>() == 5);
+  REQUIRE(handle.call<int>(10) == 15);
+  CV* cv = handle.cv();
+
+  SECTION("redefined sub")
+  {
+    interp->eval("package handlepackage; no warnings 'redefine'; sub testsub { return 20; }");
+    REQUIRE(handle.call<int>() == 20);
+  }
+
+  SECTION("assigned glob")
+  {
+    interp->eval("no warnings 'redefine'; *handlepackage::testsub = sub { return 30; };");
+    REQUIRE(handle.call<int>() == 30);
+    REQUIRE(handle.cv() != cv);
+  }
+
+  SECTION("reloaded script")
+  {
+    std::ofstream of("testload.pl");
+    of << "no warnings 'redefine'; sub testsub { return 40; }\n";
+    of.flush();
+
+    REQUIRE_NOTHROW(interp->load_script("handlepackage", "testload.pl"));
+    REQUIRE(handle.call<int>() == 40);
+  }
+
+  SECTION("aliased sub from another package")
+  {
+    interp->eval("package handlealias; sub h1 { return 1; } sub h2 { return 2; }");
+    interp->eval("*handlepackage::alias = \\&handlealias::h1;");
+    auto alias = interp->get_sub("handlepackage::alias");
+    REQUIRE(alias.call<int>() == 1);
+
+    interp->eval("no warnings 'redefine'; *handlepackage::alias = \\&handlealias::h2;");
+    REQUIRE(alias.call<int>() == 2);
+    REQUIRE(alias.call<int>() == interp->call_sub<int>("handlepackage::alias"));
+    interp->eval("delete $handlepackage::{alias};");
+  }
+
+  SECTION("deleted and redefined sub")
+  {
+    interp->eval("delete $handlepackage::{testsub};");
+    REQUIRE(!handle.exists());
+    interp->eval("package handlepackage; sub testsub { return 50; }");
+    REQUIRE(handle.call<int>() == 50);
+  }
+
+  SECTION("sub that dies")
+  {
+    interp->eval("package handlepackage; no warnings 'redefine'; sub testsub { die 'should throw'; }");
+    REQUIRE_THROWS(handle.call<void>());
+    REQUIRE(interp->get_sub("testsub").call<int>() == 5); // main::testsub
+  }
+
+  interp->eval("delete $handlepackage::{testsub};");
+}
+
+TEST_CASE("calling perl subs with multicall", "[subcaller]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("multicallpackage");
+  package.add("add", [](int a, int b) { return a + b; });
+
+  interp->eval(R"script(
+    package multicallpackage;
+    sub double { my $value = $_ * 2; return $value; }
+    sub describe { return "item $_"; }
+    sub add_args { my ($a, $b) = @_; return $a + $b; }
+    sub shift_args { return shift() * 10; }
+    sub collect { push @collected, $_; }
+    sub check { die "bad item\n" if $_ == 3; return $_; }
+    sub pad_value { my $x = $_ + 1; $x }
+  )script");
+
+  std::vector<int> items(5000);
+  for (int i = 0; i < static_cast<int>(items.size()); ++i)
+    items[i] = i;
+
+  SV** sp = PL_stack_sp;
+  sv_setpv(GvSV(PL_defgv), "original");
+
+  long long sum = 0;
+  interp->multicall<int>("multicallpackage::double", items, [&](int item, int result) {
+    REQUIRE(result == item * 2);
+    sum += result;
+  });
+  REQUIRE(sum == 4999LL * 5000);
+  REQUIRE(strcmp(SvPV_nolen(GvSV(PL_defgv)), "original") == 0); // $_ restored
+
+  auto handle = interp->get_sub("multicallpackage::describe");
+  std::vector<std::string> names;
+  std::vector<int> few = { 1, 2, 3 };
+  interp->multicall<std::string>(handle, few, [&](int, std::string result) { names.push_back(std::move(result)); });
+  REQUIRE(names == std::vector<std::string>{ "item 1", "item 2", "item 3" });
+
+  std::vector<std::tuple<int, int>> pairs = { { 1, 2 }, { 3, 4 } };
+  std::vector<int> sums;
+  interp->multicall<int>("multicallpackage::add_args", pairs, [&](const std::tuple<int, int>&, int result) { sums.push_back(result); }, perlbind::multicall_arg::args);
+  REQUIRE(sums == std::vector<int>{ 3, 7 });
+
+  sums.clear();
+  interp->multicall<int>("multicallpackage::add", pairs, [&](const std::tuple<int, int>&, int result) { sums.push_back(result); }, perlbind::multicall_arg::args);
+  REQUIRE(sums == std::vector<int>{ 3, 7 }); // xsubs are called normally
+
+  sums.clear();
+  interp->multicall<int>("multicallpackage::shift_args", few, [&](int, int result) { sums.push_back(result); }, perlbind::multicall_arg::args);
+  REQUIRE(sums == std::vector<int>{ 10, 20, 30 });
+
+  int calls = 0;
+  interp->multicall<void>("multicallpackage::collect", few, [&](int) { ++calls; });
+  REQUIRE(calls == 3);
+  AV* collected = get_av("multicallpackage::collected", 0);
+  REQUIRE((collected != nullptr && av_count(collected) == 3));
+
+  std::vector<perlbind::scalar> values;
+  interp->multicall<perlbind::scalar>("multicallpackage::pad_value", few, [&](int, perlbind::scalar result) { values.push_back(result); });
+  REQUIRE(values.size() == 3);
+  REQUIRE(values[0].as<int>() == 2);
+  REQUIRE(values[2].as<int>() == 4);
+
+  calls = 0;
+  REQUIRE_THROWS(interp->multicall<int>("multicallpackage::check", few, [&](int, int) { ++calls; }));
+  REQUIRE(calls == 2);
+
+  calls = 0;
+  REQUIRE_THROWS(interp->multicall<int>("multicallpackage::double", few, [&](int, int) {
+    if (++calls == 2)
+      throw std::runtime_error("native error");
+  }));
+  REQUIRE(calls == 2);
+
+  REQUIRE_THROWS(interp->multicall<int>("multicallpackage::missing", few, [](int, int) {}));
+  REQUIRE(strcmp(SvPV_nolen(GvSV(PL_defgv)), "original") == 0);
+  REQUIRE(PL_stack_sp == sp);
+  REQUIRE(interp->call_sub<int>("multicallpackage::add_args", 2, 3) == 5);
+}
+
+TEST_CASE("batched perl sub calls", "[subcaller]")
+{
+  auto my_perl = interp->get();
+  interp->eval(R"script(
+    package batchpackage;
+    our @events;
+    sub on_say { push @events, "say $_[0] $_[1]"; }
+    sub on_timer { die "timer failed\n" if $_[0] eq "bad"; push @events, "timer $_[0] $_[1]"; }
+  )script");
+
+  auto on_say = interp->get_sub("batchpackage::on_say");
+  auto on_timer = interp->get_sub("batchpackage::on_timer");
+  auto missing = interp->get_sub("batchpackage::missing");
+
+  std::vector<std::pair<perlbind::sub_handle*, std::tuple<std::string, int>>> calls = {
+    { &on_say,   std::make_tuple("hail", 1) },
+    { &on_timer, std::make_tuple("bad", 2) },
+    { &missing,  std::make_tuple("none", 3) },
+    { &on_timer, std::make_tuple("tick", 4) },
+  };
+
+  for (std::size_t interval : { 0, 1, 32 })
+  {
+    interp->eval("@batchpackage::events = ();");
+
+    SV** sp = PL_stack_sp;
+    SSize_t tmps = PL_tmps_ix;
+    auto errors = interp->call_batch(calls, interval);
+    REQUIRE(PL_stack_sp == sp);
+    REQUIRE(PL_tmps_ix == tmps);
+    REQUIRE(errors.size() == 2);
+    REQUIRE(errors[0].index == 1);
+    REQUIRE(errors[0].message.find("timer failed") != std::string::npos);
+    REQUIRE(errors[1].index == 2);
+    REQUIRE(errors[1].message.find("batchpackage::missing") != std::string::npos);
+
+    AV* events = get_av("batchpackage::events", 0);
+    REQUIRE((events != nullptr && av_count(events) == 2));
+    REQUIRE(strcmp(SvPV_nolen(*av_fetch(events, 0, 0)), "say hail 1") == 0);
+    REQUIRE(strcmp(SvPV_nolen(*av_fetch(events, 1, 0)), "timer tick 4") == 0);
+  }
+
+  // arguments that fail to push leave the mark and stack unchanged
+  struct batch_unregistered {};
+  batch_unregistered object;
+  std::vector<std::pair<perlbind::sub_handle*, std::tuple<batch_unregistered*>>> failed_pushes = {
+    { &on_say, std::make_tuple(&object) },
+    { &on_say, std::make_tuple(&object) },
+    { &on_say, std::make_tuple(&object) },
+  };
+
+  I32* marks = PL_markstack_ptr;
+  SV** sp = PL_stack_sp;
+  auto errors = interp->call_batch(failed_pushes);
+  REQUIRE(errors.size() == 3);
+  REQUIRE(errors[2].message.find("unregistered") != std::string::npos);
+  REQUIRE(PL_markstack_ptr == marks);
+  REQUIRE(PL_stack_sp == sp);
+}
+
+TEST_CASE("compiled perl code", "[interpreter]")
+{
+  auto my_perl = interp->get();
+
+  SECTION("compile")
+  {
+    auto code = interp->compile("my ($x, $y) = @_; return $x * $y; # trailing comment");
+    REQUIRE(code.exists());
+    REQUIRE(code.call<int>(6, 7) == 42);
+    REQUIRE(code.call<int>(2, 3) == 6);
+
+    auto dies = interp->compile("die 'compiled failure';");
+    REQUIRE_THROWS(dies.call<void>());
+    REQUIRE_THROWS(interp->compile("my $x = ;"));
+  }
+
+  SECTION("eval cache")
+  {
+    interp->use_eval_cache(2);
+    auto& cache = perlbind::detail::eval_cache::get(my_perl);
+
+    const char* reset = "$evalcache::count = 0;";
+    interp->eval(reset);
+    for (int i = 0; i < 3; ++i)
+      interp->eval("$evalcache::count++;");
+    REQUIRE(SvIV(get_sv("evalcache::count", 0)) == 3);
+    REQUIRE(cache.size() == 2);
+
+    // least recently used entry is evicted
+    interp->eval("$evalcache::count += 10;");
+    REQUIRE(cache.size() == 2);
+    CV* cv = nullptr;
+    REQUIRE(!cache.find(reset, strlen(reset), perlbind::detail::eval_cache::hash(reset, strlen(reset)), cv));
+    REQUIRE(SvIV(get_sv("evalcache::count", 0)) == 13);
+
+    REQUIRE_THROWS(interp->eval("die 'cached failure';"));
+    REQUIRE_THROWS(interp->eval("die 'cached failure';"));
+    REQUIRE_THROWS(interp->eval("my $x = ;"));
+    REQUIRE_THROWS(interp->eval("my $x = ;"));
+
+    // strings that can't be wrapped in a sub body are still accepted and
+    // strings that fail to compile are only compiled once
+    interp->eval("$evalcache::begins = 0;");
+    REQUIRE_NOTHROW(interp->eval("BEGIN { $evalcache::begins++ } $evalcache::count = 4;\n__END__\nnotes"));
+    REQUIRE(SvIV(get_sv("evalcache::begins", 0)) == 1);
+    REQUIRE_THROWS(interp->eval("BEGIN { $evalcache::begins++ } my $x = ;"));
+    REQUIRE(SvIV(get_sv("evalcache::begins", 0)) == 2);
+
+    for (int i = 0; i < 2; ++i)
+    {
+      REQUIRE_NOTHROW(interp->eval("$evalcache::count = 2;\n__END__\nnotes"));
+      REQUIRE(SvIV(get_sv("evalcache::count", 0)) == 2);
+      REQUIRE_NOTHROW(interp->eval("$evalcache::count = 3;\n\n=pod\n\nnotes\n\n=cut\n"));
+      REQUIRE(SvIV(get_sv("evalcache::count", 0)) == 3);
+    }
+
+    interp->use_eval_cache(0);
+    REQUIRE(cache.size() == 0);
+  }
+}
+
 TEST_CASE("non-owning interpreter stateless package bindings", "[interpreter][package]")
 {
   struct stateless
@@ -92,17 +438,17 @@ TEST_CASE("non-owning interpreter stateless package bindings", "[interpreter][pa
 
   CV* cv = get_cv("stateless::foo", 0);
   REQUIRE(cv != nullptr);
-  REQUIRE(GvAV(CvGV(cv)) != nullptr); // overload array should exist
+  REQUIRE(mg_find(reinterpret_cast<SV*>(cv), PERL_MAGIC_ext) != nullptr); // overload set should exist
 }
 
 TEST_CASE("typemap", "[interpreter][typemap]")
 {
   auto my_perl = interp->get();
-  auto typemap = perlbind::detail::typemap::get(my_perl);
   auto type_id = perlbind::detail::usertype<struct typemap_test*>::id();
   auto type_name = perlbind::detail::typemap::get_name<struct typemap_test*>(my_perl);
-  REQUIRE(!typemap.exists(type_id));
+  REQUIRE(perlbind::detail::typemap::get(my_perl).find(type_id) == nullptr);
   REQUIRE(type_name == nullptr);
+  REQUIRE(perlbind::detail::typemap::get_stash<struct typemap_test*>(my_perl) == nullptr);
 
   perlbind::detail::usertype<struct typemap_dummy1*>::id();
   perlbind::detail::usertype<struct typemap_dummy2*>::id();
@@ -111,9 +457,10 @@ TEST_CASE("typemap", "[interpreter][typemap]")
   auto type_id_after = perlbind::detail::usertype<struct typemap_test*>::id();
   type_name = perlbind::detail::typemap::get_name<struct typemap_test*>(my_perl);
   REQUIRE(type_id == type_id_after);
-  REQUIRE(typemap.exists(type_id));
+  REQUIRE(perlbind::detail::typemap::get(my_perl).find(type_id) != nullptr);
   REQUIRE(type_name != nullptr);
   REQUIRE(strcmp(type_name, "typemap_test") == 0);
+  REQUIRE(perlbind::detail::typemap::get_stash<struct typemap_test*>(my_perl) == gv_stashpv("typemap_test", 0));
 }
 
 TEST_CASE("multiple calls to xsub that croaks", "[subcaller][package][function]")
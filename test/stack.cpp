@@ -67,6 +67,59 @@ TEST_CASE("push C string to perl", "[stack]")
   REQUIRE(std::string(SvPV_nolen(get_sv("result", 0))) == "str");
 }
 
+TEST_CASE("read and push strings with embedded nulls", "[stack][types]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("foo");
+  package.add("str_size", [](std::string value) { return static_cast<int>(value.size()); });
+  package.add("str_echo", [](std::string value) { return value; });
+  package.add("key_size", [](perlbind::hash h) { return static_cast<int>(h.begin().key_size()); });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $size = foo::str_size("a\0b\0c");
+    $echo = foo::str_echo("a\0b");
+    $key = foo::key_size("x\0y" => 1);
+  )script"));
+
+  REQUIRE(SvIV(get_sv("size", 0)) == 5);
+  REQUIRE(SvCUR(get_sv("echo", 0)) == 3);
+  REQUIRE(SvIV(get_sv("key", 0)) == 3);
+}
+
+#ifdef __cpp_lib_string_view
+TEST_CASE("read and push std::string_view", "[stack][types]")
+{
+  struct foo
+  {
+    static std::string_view get_view() { return std::string_view("view\0data", 9); }
+  };
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("foo");
+  package.add("view_size", [](std::string_view value) { return static_cast<int>(value.size()); });
+  package.add("view_first", [](std::string_view value) { return value.substr(0, 1); });
+  package.add("get_view", &foo::get_view);
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $size = foo::view_size("a\0b\0c");
+    $first = foo::view_first("xyz");
+    $view = foo::get_view();
+  )script"));
+
+  REQUIRE(SvIV(get_sv("size", 0)) == 5);
+  REQUIRE(std::string(SvPV_nolen(get_sv("first", 0))) == "x");
+  REQUIRE(SvCUR(get_sv("view", 0)) == 9);
+
+  SECTION("view of argument buffer")
+  {
+    std::size_t diff = 1;
+    package.add("view_data", [&](std::string_view value) { diff = value.data() - SvPVX(get_sv("src", 0)); });
+    REQUIRE_NOTHROW(interp->eval("$src = 'abc'; foo::view_data($src);"));
+    REQUIRE(diff == 0);
+  }
+}
+#endif
+
 TEST_CASE("read scalar reference from perl", "[stack][types]")
 {
   struct foo
@@ -108,6 +161,62 @@ TEST_CASE("read scalar reference from perl", "[stack][types]")
   REQUIRE((get_sv("result2", 0) != nullptr && SvIV(get_sv("result2", 0)) == 3600));
 }
 
+TEST_CASE("read borrowed argument types", "[stack][types]")
+{
+  static_assert(std::is_trivially_destructible<perlbind::scalar_ref>::value, "scalar_ref should be trivial");
+  static_assert(std::is_trivially_destructible<perlbind::array_ref>::value, "array_ref should be trivial");
+  static_assert(std::is_trivially_destructible<perlbind::hash_ref>::value, "hash_ref should be trivial");
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("borrow");
+  package.add("scalar", [my_perl](perlbind::scalar_ref v) {
+    // refcount isn't incremented (scalar references are read as their referent)
+    return v.as<int>() * 10 + static_cast<int>(SvREFCNT(v.sv()));
+  });
+  package.add("array", [my_perl](perlbind::array_ref arr) {
+    REQUIRE(SvREFCNT(arr.sv()) == 1);
+    int sum = 0;
+    for (perlbind::scalar_ref item : arr)
+      sum += item.as<int>();
+    return sum * 10 + static_cast<int>(arr.size()) + static_cast<int>(arr[10].is_null());
+  });
+  package.add("hash", [my_perl](perlbind::hash_ref h) {
+    REQUIRE(SvREFCNT(h.sv()) == 1);
+    std::string keys;
+    for (auto it : h)
+      keys += it.first;
+    return keys.size() == 2 && h.exists("a") && !h.exists("c") && h["missing"].is_null() ? h["b"].as<std::string>() : "";
+  });
+  package.add("echo", [](perlbind::array_ref arr) { return arr; });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $value = 5;
+    $scalar = borrow::scalar($value);
+    $scalar_ref = borrow::scalar(\$value);
+    $array = borrow::array([1, 2, 3]);
+    my $hr = { a => 1, b => 'two' };
+    my $first = each %$hr;
+    $hash = borrow::hash($hr);
+    $missing = exists($hr->{missing}) ? 1 : 0;
+    my $n = 1;
+    $n++ while defined(each %$hr);
+    $each_count = $n;
+    $echo = borrow::echo([7]);
+  )script"));
+
+  REQUIRE(SvIV(get_sv("scalar", 0)) == 51);
+  REQUIRE(SvIV(get_sv("scalar_ref", 0)) == 52); // original and reference
+  REQUIRE(SvIV(get_sv("array", 0)) == 64);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("hash", 0)), "two") == 0);
+  REQUIRE(SvIV(get_sv("missing", 0)) == 0); // h["missing"] didn't create the key
+  REQUIRE(SvIV(get_sv("each_count", 0)) == 2); // script's each iterator wasn't reset
+  REQUIRE(SvROK(get_sv("echo", 0)));
+  REQUIRE(SvTYPE(SvRV(get_sv("echo", 0))) == SVt_PVAV);
+
+  REQUIRE_THROWS(interp->eval("borrow::array({});"));
+  REQUIRE_THROWS(interp->eval("borrow::hash([]);"));
+}
+
 TEST_CASE("push array to perl stack", "[stack][types]")
 {
   struct foo
@@ -430,6 +539,44 @@ TEST_CASE("read hash reference from perl", "[stack][types]")
   REQUIRE((get_sv("result", 0) != nullptr && SvIV(get_sv("result", 0)) == 6000));
 }
 
+TEST_CASE("read variadic argument views", "[stack][types]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("views");
+  package.add("format", [](std::string fmt, perlbind::args rest) {
+    for (perlbind::scalar_ref item : rest)
+      fmt += "," + item.as<std::string>();
+    return fmt + ":" + std::to_string(rest.size()) + ":" + std::to_string(rest.empty() ? 0 : rest.get<int>(0));
+  });
+  package.add("get_float", [](perlbind::args rest) { return rest.get<float>(1); });
+  package.add("options", [](int id, perlbind::kwargs opts) {
+    std::string keys;
+    for (auto it : opts)
+      keys += it.first;
+    return std::to_string(id) + ":" + keys + ":" + opts.get<std::string>("name") + ":" +
+           std::to_string(opts.get<int>("level", 1)) + ":" + std::to_string(opts.exists("zone")) +
+           ":" + std::to_string(opts["missing"].is_null());
+  });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $format = views::format("msg", 5, "two", 3.5);
+    $format_empty = views::format("none");
+    $float = views::get_float(1, 2.5);
+    $options = views::options(10, name => "a", zone => 3, name => "b");
+    $options_level = views::options(11, level => 7, name => "c");
+  )script"));
+
+  REQUIRE(strcmp(SvPV_nolen(get_sv("format", 0)), "msg,5,two,3.5:3:5") == 0);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("format_empty", 0)), "none:0:0") == 0);
+  REQUIRE(SvNV(get_sv("float", 0)) == 2.5);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("options", 0)), "10:namezonename:b:1:1:1") == 0);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("options_level", 0)), "11:levelname:c:7:0:1") == 0);
+
+  REQUIRE_THROWS(interp->eval("views::get_float(1);")); // index out of range
+  REQUIRE_THROWS(interp->eval("views::options(1, name => 'a', 'odd');"));
+  REQUIRE_THROWS(interp->eval("views::options(1, level => 2);")); // missing name
+}
+
 struct readtest {};
 readtest readtest_inst;
 TEST_CASE("push and read registered object reference pointers", "[stack]")
@@ -492,3 +639,185 @@ TEST_CASE("read nullable<T> types", "[stack][types]")
   REQUIRE((get_sv("result3", 0) != nullptr && SvIV(get_sv("result3", 0)) == 2));
   REQUIRE((get_sv("result4", 0) != nullptr && SvIV(get_sv("result4", 0)) == 2));
 }
+
+struct legacy_reader_type { int value; };
+struct single_pass_type { int value; };
+int single_pass_gets = 0;
+
+template <>
+struct perlbind::stack::read_as<legacy_reader_type>
+{
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return SvIOK(ST(i));
+  }
+
+  static legacy_reader_type get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+      throw std::runtime_error("expected legacy_reader_type");
+
+    return { static_cast<int>(SvIV(ST(i))) };
+  }
+};
+
+template <>
+struct perlbind::stack::read_as<single_pass_type>
+{
+  static bool check(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    return SvIOK(ST(i));
+  }
+
+  static single_pass_type get(PerlInterpreter* my_perl, int i, int ax, int items)
+  {
+    if (!check(my_perl, i, ax, items))
+      throw std::runtime_error("expected single_pass_type");
+
+    return { static_cast<int>(SvIV(ST(i))) };
+  }
+
+  static bool try_get(PerlInterpreter* my_perl, int i, int ax, int items, staged<single_pass_type>& value)
+  {
+    ++single_pass_gets;
+    if (!SvIOK(ST(i)))
+      return false;
+
+    value.emplace(single_pass_type{ static_cast<int>(SvIV(ST(i))) });
+    return true;
+  }
+};
+
+TEST_CASE("read native containers from perl", "[stack][types]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("stl");
+  package.add("sum", [](std::vector<int> v) { int sum = 0; for (int i : v) sum += i; return sum; });
+  package.add("join", [](const std::vector<std::string>& v) { std::string s; for (const auto& i : v) s += i; return s; });
+  package.add("nested", [](std::vector<std::vector<int>> v) { return static_cast<int>(v.size() * 10 + v[1].size()); });
+  package.add("vec3", [](std::array<float, 3> v) { return v[0] + v[1] + v[2]; });
+  package.add("pair", [](std::pair<int, std::string> v) { return v.second + std::to_string(v.first); });
+  package.add("tuple", [](std::tuple<int, std::string, float> v) { return std::get<1>(v) + std::to_string(std::get<0>(v)); });
+  package.add("map", [](std::map<std::string, int> v) { return v["a"] * 10 + v["b"]; });
+  package.add("ids", [](std::unordered_map<int, std::string> v) { return v[-5] + v[20]; });
+  package.add("count", [](std::map<std::string, int> v) { return static_cast<int>(v.size()); });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $sum = stl::sum([1, 2, 3, 4]);
+    $empty = stl::sum([]);
+    $join = stl::join(['a', 'b', 'c']);
+    $nested = stl::nested([[1], [1, 2, 3]]);
+    $vec3 = stl::vec3([1.5, 2.5, 3.5]);
+    $pair = stl::pair([5, 'five']);
+    $tuple = stl::tuple([6, 'six', 6.5]);
+    $map = stl::map({ a => 4, b => 2 });
+    $ids = stl::ids({ -5 => 'neg', 20 => 'pos' });
+
+    my %h = (a => 4, b => 2, c => 1);
+    my $first = each %h;
+    $count = stl::count(\%h);
+    my $n = 1;
+    $n++ while defined(each %h);
+    $each_count = $n;
+
+    my %r = (a => 1, b => 2, c => 3);
+    Internals::SvREADONLY(%r, 1);
+    delete $r{c};
+    $restricted = stl::count(\%r);
+  )script"));
+
+  REQUIRE(SvIV(get_sv("sum", 0)) == 10);
+  REQUIRE(SvIV(get_sv("empty", 0)) == 0);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("join", 0)), "abc") == 0);
+  REQUIRE(SvIV(get_sv("nested", 0)) == 23);
+  REQUIRE(SvNV(get_sv("vec3", 0)) == 7.5);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("pair", 0)), "five5") == 0);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("tuple", 0)), "six6") == 0);
+  REQUIRE(SvIV(get_sv("map", 0)) == 42);
+  REQUIRE(strcmp(SvPV_nolen(get_sv("ids", 0)), "negpos") == 0);
+  REQUIRE(SvIV(get_sv("count", 0)) == 3);
+  REQUIRE(SvIV(get_sv("each_count", 0)) == 3); // script's each iterator wasn't reset
+  REQUIRE(SvIV(get_sv("restricted", 0)) == 2); // deleted keys of restricted hashes are skipped
+
+  // incompatible containers and sizes are rejected
+  REQUIRE_THROWS(interp->eval("stl::sum({ a => 1 });"));
+  REQUIRE_THROWS(interp->eval("stl::vec3([1.5, 2.5]);"));
+  REQUIRE_THROWS(interp->eval("stl::pair([1, 'one', 2]);"));
+  REQUIRE_THROWS(interp->eval("stl::ids({ x => 'str' });"));
+#ifndef PERLBIND_NO_STRICT_SCALAR_TYPES
+  REQUIRE_THROWS(interp->eval("stl::sum([1, 'two']);"));
+#endif
+
+  // elements are read in place, the stack is restored after reading
+  REQUIRE_NOTHROW(interp->eval("@list = (1..1000); $sum = stl::sum(\\@list) + stl::sum([5]);"));
+  REQUIRE(SvIV(get_sv("sum", 0)) == 500505);
+}
+
+TEST_CASE("push native containers to perl", "[stack][types]")
+{
+  auto my_perl = interp->get();
+  auto package = interp->new_package("stl");
+  package.add("list", []() { return std::vector<int>{ 1, 2, 3 }; });
+  package.add("list_ref", []() -> perlbind::as_ref<std::vector<std::string>> { return std::vector<std::string>{ "a", "b" }; });
+  package.add("nested", []() { return std::vector<std::vector<int>>{ { 1 }, { 2, 3 } }; });
+  package.add("pairs", []() { return std::vector<std::pair<std::string, int>>{ { "x", 1 }, { "y", 2 } }; });
+  package.add("fixed", []() { return std::array<int, 2>{ { 7, 8 } }; });
+  package.add("map", []() { return std::map<std::string, int>{ { "a", 1 }, { "b", 2 } }; });
+  package.add("map_ref", []() -> perlbind::as_ref<std::unordered_map<int, bool>> { return std::unordered_map<int, bool>{ { 1, true }, { 2, false } }; });
+  package.add("empty_ref", []() -> perlbind::as_ref<std::vector<int>> { return std::vector<int>{}; });
+
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    @list = stl::list();
+    $list_ref = stl::list_ref();
+    @nested = stl::nested();
+    @pairs = stl::pairs();
+    @fixed = stl::fixed();
+    %map = stl::map();
+    $map_ref = stl::map_ref();
+    $empty_ref = stl::empty_ref();
+    $result = join(',', @list, @$list_ref, $nested[1][1], $pairs[1][0], @fixed, $map{b}, $map_ref->{1}, scalar(@$empty_ref));
+    $list_ref->[0] .= 'z'; # elements are writable
+  )script"));
+
+  REQUIRE(strcmp(SvPV_nolen(get_sv("result", 0)), "1,2,3,a,b,3,y,7,8,2,1,0") == 0);
+
+  AV* list = reinterpret_cast<AV*>(SvRV(get_sv("list_ref", 0)));
+  REQUIRE(AvFILL(list) == 1);
+  REQUIRE(SvREFCNT(AvARRAY(list)[1]) == 1); // elements are owned by the array only
+  REQUIRE(strcmp(SvPV_nolen(AvARRAY(list)[0]), "az") == 0);
+  REQUIRE(SvREFCNT(SvRV(get_sv("map_ref", 0))) == 1);
+}
+
+TEST_CASE("read custom reader types", "[stack]")
+{
+  struct foo
+  {
+    static int legacy(legacy_reader_type v) { return v.value; }
+    static int single_pass(single_pass_type v) { return v.value; }
+    static int overloaded(const char* v) { return -1; }
+    static int overloaded(legacy_reader_type v) { return v.value; }
+  };
+
+  auto my_perl = interp->get();
+  auto package = interp->new_package("foo");
+  package.add("legacy_reader", &foo::legacy);
+  package.add("single_pass_reader", &foo::single_pass);
+  package.add("overloaded_reader", (int(*)(const char*))&foo::overloaded);
+  package.add("overloaded_reader", (int(*)(legacy_reader_type))&foo::overloaded);
+
+  single_pass_gets = 0;
+  REQUIRE_NOTHROW(interp->eval(R"script(
+    $result1 = foo::legacy_reader(10);
+    $result2 = foo::single_pass_reader(20);
+    $result3 = foo::overloaded_reader(30);
+  )script"));
+
+  REQUIRE(single_pass_gets == 1);
+  REQUIRE((get_sv("result1", 0) != nullptr && SvIV(get_sv("result1", 0)) == 10));
+  REQUIRE((get_sv("result2", 0) != nullptr && SvIV(get_sv("result2", 0)) == 20));
+  REQUIRE_THROWS(interp->eval("foo::legacy_reader(\"str\");"));
+  REQUIRE_THROWS(interp->eval("foo::single_pass_reader(\"str\");"));
+#ifndef PERLBIND_NO_STRICT_SCALAR_TYPES
+  REQUIRE((get_sv("result3", 0) != nullptr && SvIV(get_sv("result3", 0)) == 30));
+#endif
+}
@@ -101,3 +101,34 @@ TEST_CASE("function traits vararg array and hash", "[traits][function]")
   STATIC_REQUIRE(perlbind::detail::function_traits<Fn5>::is_vararg == true);
   STATIC_REQUIRE(perlbind::detail::function_traits<Fn6>::is_vararg == true);
 }
+
+TEST_CASE("function argument kind masks", "[traits][function]")
+{
+  struct Foo{};
+  using masks1 = perlbind::detail::arg_masks<std::tuple<int, const char*, perlbind::reference>>;
+  using masks2 = perlbind::detail::arg_masks<std::tuple<Foo*, int>>;
+  using masks3 = perlbind::detail::arg_masks<std::tuple<>>;
+
+  STATIC_REQUIRE(masks1::exact == true);
+  STATIC_REQUIRE(masks2::exact == false); // object pointers require a derived type check
+  STATIC_REQUIRE(masks3::exact == true);
+  STATIC_REQUIRE(perlbind::stack::arg_mask<Foo*>::value == perlbind::stack::kind::object);
+  STATIC_REQUIRE(perlbind::stack::arg_mask<perlbind::reference>::value == perlbind::stack::kind::ref);
+  STATIC_REQUIRE(perlbind::stack::arg_mask<perlbind::array>::value == perlbind::stack::kind::any);
+
+  REQUIRE(masks1::get()[2] == perlbind::stack::kind::ref);
+  REQUIRE(masks2::get()[0] == perlbind::stack::kind::object);
+}
+
+struct traits_plain_object {};
+struct traits_value_object {};
+namespace perlbind { template <> struct by_value<traits_value_object> : std::true_type {}; }
+
+TEST_CASE("value object traits", "[traits]")
+{
+  STATIC_REQUIRE(perlbind::detail::is_object_class<traits_plain_object>::value == true);
+  STATIC_REQUIRE(perlbind::detail::is_value_object<traits_plain_object>::value == false);
+  STATIC_REQUIRE(perlbind::detail::is_value_object<traits_value_object>::value == true);
+  STATIC_REQUIRE(perlbind::detail::is_object_class<std::string>::value == false);
+  STATIC_REQUIRE(perlbind::detail::is_value_object<std::vector<int>>::value == false);
+}
@@ -80,6 +80,25 @@ TEST_CASE("typecasts from scalar", "[types]")
   REQUIRE(SvREFCNT(value.sv()) == 1);
 }
 
+TEST_CASE("scalar strings with embedded nulls", "[types]")
+{
+  perlbind::scalar value = std::string("a\0b", 3);
+  std::string s = value;
+  REQUIRE(s.size() == 3);
+  REQUIRE(s == std::string("a\0b", 3));
+
+#ifdef __cpp_lib_string_view
+  using namespace std::literals;
+  value = "c\0de"sv;
+  std::string_view view = value;
+  REQUIRE(view == "c\0de"sv);
+  REQUIRE(view.data() == SvPVX(value.sv())); // no copy
+
+  perlbind::scalar copy = view;
+  REQUIRE(copy.as<std::string>() == "c\0de"s);
+#endif
+}
+
 TEST_CASE("scalar as<T>", "[types]")
 {
   perlbind::scalar value = 123;
@@ -842,6 +861,19 @@ TEST_CASE("hash iterator range loop", "[types]")
   REQUIRE(SvREFCNT(src) == 1);
 }
 
+TEST_CASE("hash iterator key length", "[types]")
+{
+  perlbind::hash table;
+  table[std::string("a\0b", 3)] = 100;
+
+  auto it = table.begin();
+  REQUIRE(it.key_size() == 3);
+  REQUIRE(std::string((*it).first, it.key_size()) == std::string("a\0b", 3));
+#ifdef __cpp_lib_string_view
+  REQUIRE(it.key() == std::string_view("a\0b", 3));
+#endif
+}
+
 TEST_CASE("hash find")
 {
   perlbind::hash table;
@@ -0,0 +1 @@
+no warnings 'redefine'; sub testsub { return 40; }